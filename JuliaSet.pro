@@ -1,6 +1,6 @@
 QT       += core gui
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
 
 CONFIG += c++17
 
@@ -8,15 +8,28 @@ CONFIG += c++17
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# 渲染引擎（不依赖 Qt），也可单独编译为库，见 engine/juliaengine.pro
+include(engine/engine.pri)
+
 SOURCES += \
     colormap.cpp \
+    commandline.cpp \
+    exportqueue.cpp \
+    imageexport.cpp \
+    iterationfile.cpp \
     juliadraw.cpp \
+    juliaexplorer.cpp \
     juliawidget.cpp \
     main.cpp
 
 HEADERS += \
     colormap.h \
+    commandline.h \
+    exportqueue.h \
+    imageexport.h \
+    iterationfile.h \
     juliadraw.h \
+    juliaexplorer.h \
     juliawidget.h
 
 # Default rules for deployment.
@@ -1,6 +1,7 @@
 #include "colormap.h"
 #include <QColor>
 #include <algorithm>
+#include <cmath>
 #include <QImage>
 #include <QPainter>
 
@@ -259,6 +260,15 @@ std::function<QRgb(float)> ColorMap::getColorMapFunction(int type, float min, fl
     return [=](float x)->QRgb{return funcs[type](x, min, max);};
 }
 
+std::function<QRgb(float)> ColorMap::getDensityColorMapFunction(int type, float maxValue) {
+    float maxSqrt = std::sqrt(std::max(maxValue, 1.0f));
+    return [=](float x)->QRgb{return funcs[type](std::sqrt(std::max(x, 0.0f)), 0, maxSqrt);};
+}
+
+std::function<QRgb(float, float, float)> ColorMap::getRangeColorMapFunction(int type) {
+    return funcs[type];
+}
+
 void ColorMap::generateColorMapImage(const std::function<QRgb(float, float, float)> colorMaps[],
         int colorMapCount, const QString& outputPath, int width, int heightPerRow, float minValue, float maxValue){
     // Calculate image dimensions
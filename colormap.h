@@ -11,6 +11,12 @@ public:
     // 获取颜色映射函数
     static std::function<QRgb(float)> getColorMapFunction(int type, float, float);
 
+    // 轨道密度等动态范围很大的数据使用的颜色映射：先取平方根，再映射到 [0, sqrt(maxValue)]
+    static std::function<QRgb(float)> getDensityColorMapFunction(int type, float maxValue);
+
+    // 颜色映射的原始形式 (值, 最小值, 最大值)，范围在渲染结束后才确定时使用（如 juliaRender）
+    static std::function<QRgb(float, float, float)> getRangeColorMapFunction(int type);
+
     // 颜色函数对应的名称
     static QStringList funcNames;
 
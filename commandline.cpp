@@ -0,0 +1,183 @@
+#include "commandline.h"
+#include "colormap.h"
+#include "imageexport.h"
+#include "iterationfile.h"
+#include "juliadraw.h"
+#include "juliaverify.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <QTextStream>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace {
+
+// 命令行模式下可用的动作选项，出现其中之一即不启动图形界面
+const char* const actionOptions[] = {"--recolor", "--verify", "--scaling", "--help", "-h"};
+
+// 颜色映射可用名称（不区分大小写）或序号指定
+int colorMapIndex(const QString& value) {
+    bool isNumber = false;
+    int index = value.toInt(&isNumber);
+    if (isNumber) return (index >= 0 && index < ColorMap::funcNames.length()) ? index : -1;
+    for (int i = 0; i < ColorMap::funcNames.length(); ++i)
+        if (ColorMap::funcNames[i].compare(value, Qt::CaseInsensitive) == 0)
+            return i;
+    return -1;
+}
+
+int imageFormat(const QString& value) {
+    const QStringList names = {"png", "ppm", "bmp", "qoi", "rgba"};
+    return names.indexOf(value.toLower());
+}
+
+// --recolor：读取 .jit 迭代数据，按新的颜色映射输出图像
+int recolor(const QCommandLineParser& parser, QTextStream& err) {
+    IterationFile file;
+    const QString input = parser.value("recolor");
+    if (!file.open(input)) {
+        err << "无法读取迭代数据 " << input << ": " << file.errorString() << "\n";
+        return 1;
+    }
+
+    int colorMap = colorMapIndex(parser.value("colormap"));
+    if (colorMap < 0) {
+        err << "未知的颜色映射: " << parser.value("colormap") << "\n";
+        return 1;
+    }
+    int format = imageFormat(parser.value("format"));
+    if (format < 0) {
+        err << "未知的图像格式: " << parser.value("format") << "\n";
+        return 1;
+    }
+
+    QString output = parser.value("output");
+    if (output.isEmpty()) {
+        QFileInfo info(input);
+        output = info.path() + "/" + info.completeBaseName() + "_" + ColorMap::funcNames[colorMap]
+                 + ImageExport::suffix(static_cast<ImageFileFormat>(format));
+    }
+
+    auto getColor = file.colorMapFunction(colorMap);
+    QImage image;
+    if (parser.isSet("region")) {
+        // 只解码并上色指定区域覆盖的分块
+        const QStringList parts = parser.value("region").split(',');
+        if (parts.size() != 4) {
+            err << "--region 的格式应为 x,y,w,h\n";
+            return 1;
+        }
+        auto region = file.readRegion(parts[0].toInt(), parts[1].toInt(), parts[2].toInt(), parts[3].toInt());
+        int h = region.size(), w = h > 0 ? region[0].size() : 0;
+        if (file.hasPlane(IterationFile::BasinPlane) && w > 0) {
+            // 吸引域按吸引子上色，亮度范围取区域内的最大步数
+            auto basins = file.readRegion(parts[0].toInt(), parts[1].toInt(), parts[2].toInt(), parts[3].toInt(),
+                                          IterationFile::BasinPlane);
+            image = getBasinImage(region, basins, file.params().basinCount);
+        }
+        else {
+            image = QImage(w, h, QImage::Format_RGB32);
+            for (int y = 0; y < h; ++y)
+                for (int x = 0; x < w; ++x)
+                    image.setPixel(x, y, getColor(region[y][x]));
+        }
+    }
+    else {
+        image = file.colorize(getColor);
+    }
+
+    if (!ImageExport::save(image, output, static_cast<ImageFileFormat>(format),
+                           parser.value("compression").toInt())) {
+        err << "保存失败: " << output << "\n";
+        return 1;
+    }
+    QTextStream(stdout) << "已保存 " << output << "\n";
+    return 0;
+}
+
+// --verify：用参考内核逐像素检查所有渲染路径，与 engine/tests 中的检查程序相同
+int verify(QTextStream& out) {
+    std::ostringstream report;
+    int status = runVerify(report);
+    out << QString::fromStdString(report.str());
+    out.flush();
+    return status;
+}
+
+// --scaling：用默认函数测量 1..N 个线程的吞吐量
+int scaling(const QCommandLineParser& parser, QTextStream& out) {
+    int size = std::max(16, parser.value("size").toInt());
+    int maxThreads = parser.value("threads").toInt();
+    auto func = getRationalFunctionLambda("z^2+(-0.7+0.27015i)").first;
+    auto samples = measureThreadScaling(-1.5, 1.5, -1.5, 1.5, size, size, func, 1000, 2.0, maxThreads);
+    if (samples.empty()) return 1;
+
+    out << QString("%1 %2 %3 %4\n").arg("线程", 6).arg("耗时(s)", 10).arg("迭代/秒", 12).arg("加速比", 8);
+    for (const auto& s : samples) {
+        out << QString("%1 %2 %3 %4\n")
+                   .arg(s.threads, 6)
+                   .arg(s.seconds, 10, 'f', 3)
+                   .arg(s.iterationsPerSecond, 12, 'g', 4)
+                   .arg(s.iterationsPerSecond / samples.front().iterationsPerSecond, 8, 'f', 2);
+    }
+    out.flush();
+    return 0;
+}
+
+} // namespace
+
+bool isCommandLineInvocation(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i)
+        for (const char* option : actionOptions)
+            if (std::strcmp(argv[i], option) == 0)
+                return true;
+    return false;
+}
+
+int runCommandLine(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Julia Set 绘制程序的命令行模式");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"recolor", "读取 .jit 迭代数据并重新上色。", "file.jit"},
+        {"colormap", "颜色映射名称或序号，默认 0 (Jet)。", "name", "0"},
+        {"format", "输出格式：png, ppm, bmp, qoi, rgba。", "format", "png"},
+        {"compression", "PNG 压缩等级 0-9。", "level", "6"},
+        {"output", "输出文件路径。", "path"},
+        {"region", "只输出 x,y,w,h 区域。", "x,y,w,h"},
+        {"verify", "以参考内核逐像素检查所有渲染路径，有不一致时返回非零。"},
+        {"scaling", "测量 1..N 个线程的渲染吞吐量，N 由 --threads 指定（默认为可用 CPU 数）。"},
+        {"size", "--scaling 使用的图像边长。", "px", "1024"},
+        {"threads", "渲染线程数，0 为自动。", "n", "0"},
+        {"pin", "将渲染线程绑定到 CPU 核心（仅 Linux）。"},
+    });
+    parser.process(app);
+
+    if (!parser.isSet("scaling")) {
+        RenderThreadSettings settings;
+        settings.threadCount = std::max(0, parser.value("threads").toInt());
+        settings.pinThreads = parser.isSet("pin");
+        setRenderThreadSettings(settings);
+    }
+
+    QTextStream err(stderr);
+    if (parser.isSet("recolor"))
+        return recolor(parser, err);
+    if (parser.isSet("verify")) {
+        QTextStream out(stdout);
+        return verify(out);
+    }
+    if (parser.isSet("scaling")) {
+        RenderThreadSettings settings;
+        settings.pinThreads = parser.isSet("pin");
+        setRenderThreadSettings(settings);
+        QTextStream out(stdout);
+        return scaling(parser, out);
+    }
+
+    parser.showHelp(1);
+    return 1;
+}
@@ -0,0 +1,13 @@
+#ifndef COMMANDLINE_H
+#define COMMANDLINE_H
+
+// 命令行模式：不启动图形界面，直接处理文件后退出
+// 用法见 JuliaSet --help
+
+// 参数中包含命令行模式的选项时返回 true
+bool isCommandLineInvocation(int argc, char* argv[]);
+
+// 执行命令行模式，返回进程退出码
+int runCommandLine(int argc, char* argv[]);
+
+#endif // COMMANDLINE_H
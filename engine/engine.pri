@@ -0,0 +1,17 @@
+# Julia 集渲染引擎，不依赖 Qt
+# 图形界面直接 include 本文件编译进程序；engine/juliaengine.pro 把它编译为独立的库
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/juliacheckpoint.cpp \
+    $$PWD/juliaengine.cpp \
+    $$PWD/juliarender.cpp \
+    $$PWD/juliaverify.cpp
+
+HEADERS += \
+    $$PWD/juliacheckpoint.h \
+    $$PWD/juliaengine.h \
+    $$PWD/juliarender.h \
+    $$PWD/juliaverify.h
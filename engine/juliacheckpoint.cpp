@@ -0,0 +1,152 @@
+#include "juliacheckpoint.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char checkpointMagic[4] = {'J', 'C', 'K', 'P'};
+const uint32_t checkpointVersion = 1;
+const long long dataAlignment = 4096;
+
+template <typename T>
+void append(std::vector<char>& out, const T& value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+// 参数块：决定检查点能否续用的全部参数。迭代内核不影响结果，不写入
+std::vector<char> serializeParams(const JuliaRenderParams& params, int bandRows) {
+    std::vector<char> block;
+    append(block, static_cast<int32_t>(params.width));
+    append(block, static_cast<int32_t>(params.height));
+    append(block, static_cast<int32_t>(params.maxIterations));
+    append(block, static_cast<int32_t>(bandRows));
+    append(block, params.realMin);
+    append(block, params.realMax);
+    append(block, params.imagMin);
+    append(block, params.imagMax);
+    append(block, params.escapeRadius);
+    append(block, static_cast<uint32_t>(params.function.size()));
+    block.insert(block.end(), params.function.begin(), params.function.end());
+    return block;
+}
+
+} // namespace
+
+RenderCheckpoint::RenderCheckpoint(const std::string& path, const JuliaRenderParams& params, int bandRows)
+    : path(path), width(params.width), height(params.height), rowsPerBand(std::max(1, bandRows)) {
+    const std::vector<char> block = serializeParams(params, rowsPerBand);
+    const int bands = (height + rowsPerBand - 1) / rowsPerBand;
+    bitmapOffset = sizeof(checkpointMagic) + 2 * sizeof(uint32_t) + static_cast<long long>(block.size());
+    dataOffset = (bitmapOffset + bands + dataAlignment - 1) / dataAlignment * dataAlignment;
+    done.assign(bands, 0);
+
+    // 先尝试续用已有的文件：文件头完全相同才读取完成位图
+    file = std::fopen(path.c_str(), "r+b");
+    if (file) {
+        std::vector<char> header(bitmapOffset);
+        bool same = std::fread(header.data(), 1, header.size(), file) == header.size() &&
+                    std::memcmp(header.data(), checkpointMagic, sizeof(checkpointMagic)) == 0;
+        if (same) {
+            uint32_t version = 0, size = 0;
+            std::memcpy(&version, header.data() + 4, sizeof(version));
+            std::memcpy(&size, header.data() + 8, sizeof(size));
+            same = version == checkpointVersion && size == block.size() &&
+                   std::memcmp(header.data() + 12, block.data(), block.size()) == 0;
+        }
+        if (same && std::fread(done.data(), 1, done.size(), file) == done.size())
+            return;
+        std::fclose(file);
+        std::fill(done.begin(), done.end(), 0);
+    }
+
+    // 新建：写文件头和全 0 的完成位图
+    file = std::fopen(path.c_str(), "w+b");
+    if (!file)
+        throw std::runtime_error("无法创建检查点文件 " + path);
+    std::vector<char> header(checkpointMagic, checkpointMagic + sizeof(checkpointMagic));
+    append(header, checkpointVersion);
+    append(header, static_cast<uint32_t>(block.size()));
+    header.insert(header.end(), block.begin(), block.end());
+    header.insert(header.end(), done.begin(), done.end());
+    if (std::fwrite(header.data(), 1, header.size(), file) != header.size()) {
+        std::fclose(file);
+        file = nullptr;
+        throw std::runtime_error("写入检查点文件失败 " + path);
+    }
+    sync();
+}
+
+RenderCheckpoint::~RenderCheckpoint() {
+    if (file) std::fclose(file);
+}
+
+int RenderCheckpoint::bandLastRow(int band) const {
+    return std::min(height, (band + 1) * rowsPerBand);
+}
+
+void RenderCheckpoint::seek(long long offset) {
+#ifdef _WIN32
+    int failed = _fseeki64(file, offset, SEEK_SET);
+#else
+    int failed = fseeko(file, static_cast<off_t>(offset), SEEK_SET);
+#endif
+    if (failed)
+        throw std::runtime_error("定位检查点文件失败 " + path);
+}
+
+void RenderCheckpoint::sync() {
+    if (std::fflush(file) != 0)
+        throw std::runtime_error("写入检查点文件失败 " + path);
+#ifdef _WIN32
+    _commit(_fileno(file));
+#else
+    fsync(fileno(file));
+#endif
+}
+
+void RenderCheckpoint::readBand(int band, const std::function<int*(int)>& rowOut) {
+    seek(dataOffset + static_cast<long long>(bandFirstRow(band)) * width * sizeof(int32_t));
+    for (int y = bandFirstRow(band); y < bandLastRow(band); ++y) {
+        if (std::fread(rowOut(y), sizeof(int32_t), width, file) != static_cast<size_t>(width))
+            throw std::runtime_error("读取检查点文件失败 " + path);
+    }
+}
+
+void RenderCheckpoint::writeBand(int band, const std::function<int*(int)>& rowOut) {
+    seek(dataOffset + static_cast<long long>(bandFirstRow(band)) * width * sizeof(int32_t));
+    for (int y = bandFirstRow(band); y < bandLastRow(band); ++y) {
+        if (std::fwrite(rowOut(y), sizeof(int32_t), width, file) != static_cast<size_t>(width))
+            throw std::runtime_error("写入检查点文件失败 " + path);
+    }
+    written.push_back(band);
+}
+
+void RenderCheckpoint::commit() {
+    if (written.empty()) return;
+    // 先让数据落盘，再标记完成：中断时位图中不会出现数据不完整的条带
+    sync();
+    for (int band : written) {
+        done[band] = 1;
+        seek(bitmapOffset + band);
+        if (std::fputc(1, file) == EOF)
+            throw std::runtime_error("写入检查点文件失败 " + path);
+    }
+    written.clear();
+    sync();
+}
+
+void RenderCheckpoint::remove() {
+    if (file) {
+        std::fclose(file);
+        file = nullptr;
+    }
+    std::remove(path.c_str());
+}
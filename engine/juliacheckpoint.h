@@ -0,0 +1,61 @@
+#ifndef JULIACHECKPOINT_H
+#define JULIACHECKPOINT_H
+
+#include "juliarender.h"
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * 长时间渲染的检查点文件，由 juliaRenderCheckpointed 使用。
+ *
+ * 文件布局（本机字节序）：
+ *   文件头     magic "JCKP"、版本号、参数块长度、参数块（渲染参数与条带行数）
+ *   完成位图   每个条带一个字节，1 表示该条带的数据已经落盘
+ *   迭代数据   从 4096 字节对齐处开始，width * height 个 int32，按行存放
+ *
+ * 条带数据随写随存，commit() 时先 fsync 数据，再写完成位图并 fsync，
+ * 因此任何时刻中断，位图中标记完成的条带都有完整的数据。
+ */
+class RenderCheckpoint {
+public:
+    // 打开 path 处的检查点；文件不存在或参数与 params 不同时新建。失败时抛出 std::runtime_error
+    RenderCheckpoint(const std::string& path, const JuliaRenderParams& params, int bandRows);
+    ~RenderCheckpoint();
+    RenderCheckpoint(const RenderCheckpoint&) = delete;
+    RenderCheckpoint& operator=(const RenderCheckpoint&) = delete;
+
+    int bandCount() const { return static_cast<int>(done.size()); }
+    int bandRows() const { return rowsPerBand; }
+    // 条带 band 的行范围 [first, last)
+    int bandFirstRow(int band) const { return band * rowsPerBand; }
+    int bandLastRow(int band) const;
+    // 条带是否已落盘（不含尚未 commit 的条带）
+    bool isDone(int band) const { return done[band] != 0; }
+
+    // 读取已落盘的条带，写入 rowOut(y) 返回的各行
+    void readBand(int band, const std::function<int*(int)>& rowOut);
+    // 写入条带数据，commit() 之后才算完成
+    void writeBand(int band, const std::function<int*(int)>& rowOut);
+    // 把已写入的条带落盘并标记为完成
+    void commit();
+    // 关闭并删除检查点文件
+    void remove();
+
+private:
+    void seek(long long offset);
+    void sync();
+
+    std::string path;
+    std::FILE* file = nullptr;
+    int width = 0;
+    int height = 0;
+    int rowsPerBand = 1;
+    long long bitmapOffset = 0;
+    long long dataOffset = 0;
+    std::vector<char> done;
+    std::vector<int> written; // 已写入、尚未 commit 的条带
+};
+
+#endif // JULIACHECKPOINT_H
@@ -0,0 +1,471 @@
+#include "juliaengine.h"
+#include <fstream>
+#include <memory>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#endif
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+// ==========================================
+// 渲染线程池
+// ==========================================
+
+namespace {
+
+// 本进程允许运行的 CPU 编号列表
+std::vector<int> allowedCpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+    }
+#endif
+    return cpus;
+}
+
+// cgroup v2 的 CPU 配额（cpu.max 为 "quota period"），没有限制时返回 0
+int cgroupCpuQuota() {
+#ifdef __linux__
+    std::ifstream file("/sys/fs/cgroup/cpu.max");
+    std::string quota;
+    long long period = 0;
+    if (file >> quota >> period && quota != "max" && period > 0) {
+        try {
+            long long q = std::stoll(quota);
+            return static_cast<int>(std::max(1LL, (q + period - 1) / period));
+        } catch (...) {}
+    }
+#endif
+    return 0;
+}
+
+std::mutex poolMutex;
+RenderThreadSettings currentSettings;
+std::shared_ptr<RenderThreadPool> currentPool;
+// 本线程使用的线程池，为空时使用全局线程池
+thread_local RenderThreadPool* threadPool = nullptr;
+
+} // namespace
+
+int defaultRenderThreadCount() {
+    int count = static_cast<int>(allowedCpus().size());
+    if (count == 0) count = static_cast<int>(std::thread::hardware_concurrency());
+    int quota = cgroupCpuQuota();
+    if (quota > 0) count = count > 0 ? std::min(count, quota) : quota;
+    return std::max(1, count);
+}
+
+void setRenderThreadSettings(const RenderThreadSettings& settings) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (currentPool && settings.threadCount == currentSettings.threadCount &&
+        settings.pinThreads == currentSettings.pinThreads &&
+        settings.lowPriority == currentSettings.lowPriority)
+        return;
+    currentSettings = settings;
+    currentPool.reset();
+}
+
+RenderThreadSettings renderThreadSettings() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return currentSettings;
+}
+
+int renderThreadCount() {
+    return renderThreadPool().threadCount();
+}
+
+void lowerCurrentThreadPriority() {
+#ifdef __linux__
+    sched_param param{};
+    if (sched_setscheduler(0, SCHED_IDLE, &param) != 0)
+        setpriority(PRIO_PROCESS, 0, 19); // Linux 上 nice 值是线程级的
+#endif
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_IDLE);
+#endif
+}
+
+ScopedRenderThreadPool::ScopedRenderThreadPool(RenderThreadPool& pool) : previous(threadPool) {
+    threadPool = &pool;
+}
+
+ScopedRenderThreadPool::~ScopedRenderThreadPool() {
+    threadPool = previous;
+}
+
+RenderThreadPool& renderThreadPool() {
+    if (threadPool) return *threadPool;
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (!currentPool)
+        currentPool = std::make_shared<RenderThreadPool>(currentSettings);
+    return *currentPool;
+}
+
+void renderParallelFor(int count, const std::function<void(int)>& func) {
+    if (threadPool) {
+        threadPool->parallelFor(count, func);
+        return;
+    }
+    // 持有全局线程池的引用，执行期间被替换的线程池在最后一个使用者返回后才销毁
+    std::shared_ptr<RenderThreadPool> pool;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (!currentPool)
+            currentPool = std::make_shared<RenderThreadPool>(currentSettings);
+        pool = currentPool;
+    }
+    pool->parallelFor(count, func);
+}
+
+RenderThreadPool::RenderThreadPool(const RenderThreadSettings& settings)
+    : lowPriority(settings.lowPriority) {
+    int count = settings.threadCount > 0 ? settings.threadCount : defaultRenderThreadCount();
+    std::vector<int> cpus = settings.pinThreads ? allowedCpus() : std::vector<int>();
+    for (int i = 1; i < count; ++i) {
+        workers.emplace_back(&RenderThreadPool::workerLoop, this, i);
+#ifdef __linux__
+        // 第 0 个 CPU 留给调用线程，工作线程依次绑定到其余 CPU
+        if (!cpus.empty()) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpus[i % cpus.size()], &set);
+            pthread_setaffinity_np(workers.back().native_handle(), sizeof(set), &set);
+        }
+#endif
+    }
+}
+
+RenderThreadPool::~RenderThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCondition.notify_all();
+    for (auto& worker : workers)
+        if (worker.joinable()) worker.join();
+}
+
+void RenderThreadPool::runIndex(Job& job, int index) {
+    (*job.func)(index);
+    // 在锁内计数并通知：调用线程看到全部完成后 job 即被销毁，解锁之后不能再访问 job
+    std::lock_guard<std::mutex> lock(job.doneMutex);
+    if (++job.done == job.count)
+        job.doneCondition.notify_all();
+}
+
+void RenderThreadPool::workerLoop(int) {
+    threadPool = this;
+    if (lowPriority) lowerCurrentThreadPriority();
+    for (;;) {
+        Job* job = nullptr;
+        int index = 0;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) return;
+            job = queue.front();
+            // 在队列锁内领取下标：领到下标后 job 在该下标完成前不会被销毁
+            index = job->next.fetch_add(1);
+            if (index >= job->count) {
+                // 所有下标都已被领取的任务移出队列
+                queue.pop_front();
+                continue;
+            }
+        }
+        runIndex(*job, index);
+    }
+}
+
+void RenderThreadPool::parallelFor(int count, const std::function<void(int)>& func) {
+    if (count <= 0) return;
+    Job job;
+    job.func = &func;
+    job.count = count;
+
+    if (!workers.empty() && count > 1) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queue.push_back(&job);
+        }
+        queueCondition.notify_all();
+    }
+
+    // 调用线程也参与计算
+    for (int index = job.next.fetch_add(1); index < count; index = job.next.fetch_add(1))
+        runIndex(job, index);
+
+    {
+        std::unique_lock<std::mutex> lock(job.doneMutex);
+        job.doneCondition.wait(lock, [&job] { return job.done == job.count; });
+    }
+    {
+        // job 在栈上，返回前确保它已不在队列中
+        std::lock_guard<std::mutex> lock(queueMutex);
+        auto it = std::find(queue.begin(), queue.end(), &job);
+        if (it != queue.end()) queue.erase(it);
+    }
+}
+
+
+
+// ==========================================
+// 交互帧的质量控制
+// ==========================================
+
+void FrameQualityController::record(long long pixels, long long iterations, long long cappedPixels,
+                                    int maxIterations, double seconds) {
+    // 太短的计时误差太大，不用于估计吞吐量
+    if (pixels <= 0 || seconds < 1e-3) return;
+    double measured = static_cast<double>(iterations + pixels) / seconds;
+    workPerSecond = workPerSecond > 0 ? smoothing * measured + (1 - smoothing) * workPerSecond : measured;
+    cappedFraction = static_cast<double>(cappedPixels) / pixels;
+    escapedPerPixel = std::max(0.0, static_cast<double>(iterations) - static_cast<double>(cappedPixels) * maxIterations) / pixels;
+}
+
+double FrameQualityController::predictSeconds(int resolution, int maxIterations) const {
+    if (!hasEstimate()) return 0;
+    double perPixel = 1 + escapedPerPixel + cappedFraction * maxIterations;
+    return static_cast<double>(resolution) * resolution * perPixel / workPerSecond;
+}
+
+FrameQuality FrameQualityController::choose(int resolution, int maxIterations, double targetSeconds) const {
+    FrameQuality quality;
+    quality.resolution = resolution;
+    quality.maxIterations = maxIterations;
+    if (!hasEstimate() || resolution <= 0 || maxIterations <= 0 || targetSeconds <= 0) return quality;
+
+    quality.predictedSeconds = predictSeconds(resolution, maxIterations);
+    if (quality.predictedSeconds <= targetSeconds) return quality;
+
+    // 耗时与像素数成正比，先按比例缩小边长
+    const int floorResolution = std::min(resolution, minResolution);
+    quality.resolution = std::max(floorResolution,
+        static_cast<int>(resolution * std::sqrt(targetSeconds / quality.predictedSeconds)));
+    quality.predictedSeconds = predictSeconds(quality.resolution, maxIterations);
+    if (quality.predictedSeconds <= targetSeconds || cappedFraction <= 0) return quality;
+
+    // 边长已到下限，再降低最大迭代次数：只影响未逃逸的像素
+    const double pixels = static_cast<double>(quality.resolution) * quality.resolution;
+    const double budgetPerPixel = targetSeconds * workPerSecond / pixels;
+    const double iterations = (budgetPerPixel - 1 - escapedPerPixel) / cappedFraction;
+    quality.maxIterations = std::max(std::min(maxIterations, minIterations),
+                                     std::min(maxIterations, static_cast<int>(iterations)));
+    quality.predictedSeconds = predictSeconds(quality.resolution, quality.maxIterations);
+    return quality;
+}
+
+// 计算 Mandelbrot 集并返回一个二维矩阵，表示迭代了多少次
+std::vector<std::vector<int>> generateMandelbrotMatrix(int width, int height, const int n, const std::complex<double>& constant, int maxIterations) {
+    std::vector<std::vector<int>> matrix(height, std::vector<int>(width));
+    double scaleX = 3.0 / width;
+    double scaleY = 3.0 / height;
+
+    auto computeRow = [&](int startY, int step) {
+        for (int y = startY; y < height; y += step) {
+            for (int x = 0; x < width; ++x) {
+                std::complex<double> c((x - width / 2) * scaleX, (y - height / 2) * scaleY);
+                std::complex<double> z(0, 0);
+                int iterations = 0;
+                while (std::abs(z) < 2.0 && iterations < maxIterations) {
+                    z = pow(z, n) + c;
+                    ++iterations;
+                }
+                matrix[y][x] = iterations;
+            }
+        }
+    };
+
+    // 使用渲染线程池并行计算
+    parallelForRows(height, [&](int y) { computeRow(y, height); });
+
+    return matrix;
+}
+
+// ==========================================
+// 有理函数的吸引域
+// ==========================================
+
+namespace {
+
+using Coefficients = std::vector<std::complex<double>>;
+
+const double pi = std::acos(-1.0);
+
+// 去掉为 0 的最高次系数
+Coefficients trimmed(Coefficients coeffs) {
+    while (coeffs.size() > 1 && coeffs.back() == std::complex<double>(0, 0))
+        coeffs.pop_back();
+    return coeffs;
+}
+
+Coefficients derivative(const Coefficients& coeffs) {
+    Coefficients result;
+    for (size_t k = 1; k < coeffs.size(); ++k)
+        result.push_back(coeffs[k] * static_cast<double>(k));
+    return result;
+}
+
+Coefficients multiply(const Coefficients& a, const Coefficients& b) {
+    Coefficients result(a.size() + b.size() - 1);
+    for (size_t i = 0; i < a.size(); ++i)
+        for (size_t j = 0; j < b.size(); ++j)
+            result[i + j] += a[i] * b[j];
+    return result;
+}
+
+/**
+ * 圆盘 D(a, radius) 是否一定被 R 映入自身并收敛到 a。
+ *
+ * 用圆盘算术求 R' = N / Q^2（N = P'Q - PQ'）在 D 上的上界 k：D 内没有极点且 k < 1 时，
+ * 对 D 内的 w 有 |R(w) - R(a)| <= k |w - a|。a 只是数值上的不动点，再要求 |R(a) - a| 小于 (1 - k) * radius 的一半，
+ * 则 R(D) 包含于 D，D 内的轨道都收敛到 D 中唯一的不动点。
+ */
+bool capturesOrbits(const RationalAttractors& f, const Coefficients& derivativeNumerator,
+                    const RationalAttractor& a, double radius) {
+    const ComplexDisc disc{a.point, radius};
+    const ComplexDisc q = evalPolynomialDisc(f.denominator, disc);
+    const double qMin = std::abs(q.center) - q.radius;
+    if (!(qMin > 0)) return false;
+    const ComplexDisc n = evalPolynomialDisc(derivativeNumerator, disc);
+    const double bound = (std::abs(n.center) + n.radius) / (qMin * qMin);
+    const double factor = (1 + std::abs(a.multiplier)) / 2;
+    if (!(bound <= factor)) return false;
+    const double drift = std::abs(evalPolynomial(f.numerator, a.point) / evalPolynomial(f.denominator, a.point) - a.point);
+    return drift < (1 - bound) * radius / 2;
+}
+
+// |z| >= 返回值时一定有 |R(z)| > |z|（按系数的模估计），无穷远点不吸引时返回 0
+double infinityCaptureRadius(const RationalAttractors& f) {
+    if (!f.infinityAttracting) return 0;
+    const Coefficients& P = f.numerator;
+    const Coefficients& Q = f.denominator;
+    // |R(z)| >= growth * |z|，growth 取首项系数之比的模与 1 的中点（次数差至少为 2 时取 2）
+    const int degreeDifference = static_cast<int>(P.size()) - static_cast<int>(Q.size());
+    const double leadingRatio = std::abs(P.back()) / std::abs(Q.back());
+    const double growth = degreeDifference >= 2 ? 2.0 : (1 + leadingRatio) / 2;
+    // 下界 (|p_n| r^n - sum |p_k| r^k) / (sum |q_k| r^k) 除以 r 后随 r 单调增加，成立一次即对更大的 r 都成立
+    for (double r = 1; r < 1e150; r *= 2) {
+        double lower = std::abs(P.back()) * std::pow(r, static_cast<double>(P.size() - 1));
+        for (size_t k = 0; k + 1 < P.size(); ++k)
+            lower -= std::abs(P[k]) * std::pow(r, static_cast<double>(k));
+        double upper = 0;
+        for (size_t k = 0; k < Q.size(); ++k)
+            upper += std::abs(Q[k]) * std::pow(r, static_cast<double>(k));
+        if (lower >= growth * r * upper) return r;
+    }
+    return 1e150;
+}
+
+} // namespace
+
+std::vector<std::complex<double>> polynomialRoots(const std::vector<std::complex<double>>& coeffs) {
+    const Coefficients p = trimmed(coeffs);
+    const int degree = static_cast<int>(p.size()) - 1;
+    if (degree < 1) return {};
+    if (p.back() == std::complex<double>(0, 0))
+        throw std::invalid_argument("多项式为 0");
+
+    // 首一化后用 Durand-Kerner 同时迭代全部根，初值取在根的上界圆上
+    Coefficients monic(p.size());
+    for (size_t k = 0; k < p.size(); ++k) monic[k] = p[k] / p.back();
+    double bound = 0;
+    for (int k = 0; k < degree; ++k) bound = std::max(bound, std::abs(monic[k]));
+    bound += 1;
+    std::vector<std::complex<double>> roots(degree);
+    for (int i = 0; i < degree; ++i)
+        roots[i] = std::polar(bound, 2 * pi * i / degree + 0.4);
+
+    for (int iteration = 0; iteration < 500; ++iteration) {
+        double change = 0;
+        for (int i = 0; i < degree; ++i) {
+            std::complex<double> denominator(1, 0);
+            for (int j = 0; j < degree; ++j)
+                if (j != i) denominator *= roots[i] - roots[j];
+            if (denominator == std::complex<double>(0, 0)) denominator = 1e-12;
+            std::complex<double> step = evalPolynomial(monic, roots[i]) / denominator;
+            roots[i] -= step;
+            change = std::max(change, std::abs(step) / (1 + std::abs(roots[i])));
+        }
+        if (change < 1e-14) break;
+    }
+
+    // 用原多项式的牛顿迭代修正，消除首一化带来的误差
+    const Coefficients dp = derivative(p);
+    for (auto& root : roots) {
+        for (int iteration = 0; iteration < 3; ++iteration) {
+            std::complex<double> d = evalPolynomial(dp, root);
+            if (d == std::complex<double>(0, 0)) break;
+            root -= evalPolynomial(p, root) / d;
+        }
+    }
+    return roots;
+}
+
+RationalAttractors findRationalAttractors(const ParsedFunction& f) {
+    RationalAttractors result;
+    result.numerator = trimmed(f.numerator);
+    result.denominator = f.denominator.empty() ? Coefficients{1} : trimmed(f.denominator);
+    const Coefficients& P = result.numerator;
+    const Coefficients& Q = result.denominator;
+    if (Q.size() == 1) {
+        if (Q[0] == std::complex<double>(0, 0))
+            throw std::invalid_argument("分母为 0");
+        for (auto& c : result.numerator) c /= Q[0];
+        result.denominator = {1};
+    }
+
+    // 无穷远点：R(z) ~ (p_n / q_m) z^(n-m)
+    const int degreeP = static_cast<int>(P.size()) - 1;
+    const int degreeQ = static_cast<int>(Q.size()) - 1;
+    result.infinityFixed = degreeP > degreeQ;
+    result.infinityAttracting = degreeP >= degreeQ + 2 ||
+                                (degreeP == degreeQ + 1 && std::abs(P.back()) > std::abs(Q.back()));
+    if (!result.infinityFixed)
+        result.infinityImage = degreeP == degreeQ ? P.back() / Q.back() : std::complex<double>(0, 0);
+    result.infinityRadius = infinityCaptureRadius(result);
+
+    // 有限不动点为 P(z) - z Q(z) 的根，乘子 R'(z) = (P'Q - PQ') / Q^2
+    Coefficients fixedPolynomial(std::max(P.size(), Q.size() + 1));
+    for (size_t k = 0; k < P.size(); ++k) fixedPolynomial[k] += P[k];
+    for (size_t k = 0; k < Q.size(); ++k) fixedPolynomial[k + 1] -= Q[k];
+    fixedPolynomial = trimmed(fixedPolynomial);
+    if (fixedPolynomial.size() == 1 && fixedPolynomial[0] == std::complex<double>(0, 0))
+        return result; // R(z) = z，没有吸引不动点
+    const std::vector<std::complex<double>> fixedPoints = polynomialRoots(fixedPolynomial);
+    const std::vector<std::complex<double>> poles = polynomialRoots(Q);
+
+    const Coefficients dP = derivative(P), dQ = derivative(Q);
+    Coefficients derivativeNumerator = multiply(dP.empty() ? Coefficients{0} : dP, Q);
+    const Coefficients PdQ = multiply(P, dQ.empty() ? Coefficients{0} : dQ);
+    derivativeNumerator.resize(std::max(derivativeNumerator.size(), PdQ.size()));
+    for (size_t k = 0; k < PdQ.size(); ++k) derivativeNumerator[k] -= PdQ[k];
+    for (const auto& point : fixedPoints) {
+        std::complex<double> q = evalPolynomial(Q, point);
+        if (q == std::complex<double>(0, 0)) continue;
+        std::complex<double> multiplier =
+            (evalPolynomial(dP, point) * q - evalPolynomial(P, point) * evalPolynomial(dQ, point)) / (q * q);
+        if (!(std::abs(multiplier) < 1)) continue;
+
+        // 捕获半径不超过到其他不动点和极点距离的一半，再缩小到能证明圆盘映入自身为止
+        double radius = 0.1;
+        for (const auto& other : fixedPoints)
+            if (&other != &point && other != point) radius = std::min(radius, std::abs(other - point) / 2);
+        for (const auto& pole : poles)
+            radius = std::min(radius, std::abs(pole - point) / 2);
+        RationalAttractor attractor{point, multiplier, 0};
+        while (radius > 1e-9 && !capturesOrbits(result, derivativeNumerator, attractor, radius))
+            radius /= 2;
+        if (radius <= 1e-9) continue;
+        attractor.captureRadius = radius;
+        result.finite.push_back(attractor);
+    }
+    return result;
+}
@@ -0,0 +1,1840 @@
+#ifndef JULIAENGINE_H
+#define JULIAENGINE_H
+
+// Julia 集渲染引擎的核心部分，不依赖 Qt。
+// 图形界面、命令行和 juliarender.h 中的库接口都建立在这里的函数之上。
+
+#include "juliarender.h"
+#include <vector>
+#include <complex>
+#include <functional>
+#include <string>
+#include <sstream>
+#include <regex>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+#include <random>
+#include <stdexcept>
+
+
+// 渲染模式：逃逸时间 / Buddhabrot / anti-Buddhabrot / 参数图集
+enum RenderMode { EscapeTime = 0, Buddhabrot = 1, AntiBuddhabrot = 2, ParameterAtlas = 3, AttractorBasins = 4 };
+
+// 对单个点做逃逸时间迭代，返回迭代了多少次
+template <typename Func>
+inline int juliaEscapeTime(std::complex<double> z, const Func& func, int maxIterations, double escapeRadiusSq) {
+    int iterations = 0;
+    while (std::norm(z) < escapeRadiusSq && iterations < maxIterations) {
+        z = func(z);
+        ++iterations;
+    }
+    return iterations;
+}
+
+/**
+ * 平滑（分数）逃逸值：对在第 n 次迭代后逃逸、此时为 z_n 的像素，
+ *     nu = n + 1 - log(log|z_n| / log R) / log d
+ * 其中 R 为逃逸半径，d 为函数在无穷远处的次数。nu 随像素坐标连续变化，消除整数迭代次数的色带；
+ * 未逃逸的像素取 maxIterations。d <= 1 或 R <= 1 时无法平滑，直接返回整数迭代次数。
+ *
+ * 逃逸半径较小（如 2）时 z_n 还没有进入 |z|^d 主导的区域，公式在色带边界处仍有跳变，
+ * 因此先把 z 继续迭代到 |z| >= 1e10（通常只需几次），再以实际的迭代次数代入公式。
+ * 由于分母仍是 log R，结果与按逃逸半径 R 计数的迭代次数处在同一尺度上。
+ */
+struct SmoothEscape {
+    int maxIterations = 0;
+    double logEscapeRadius = 0;
+    double invLogDegree = 0; // 1 / log d，为 0 时不平滑
+
+    SmoothEscape() = default;
+    SmoothEscape(int degree, int maxIterations, double escapeRadius)
+        : maxIterations(maxIterations) {
+        if (degree > 1 && escapeRadius > 1) {
+            logEscapeRadius = std::log(escapeRadius);
+            invLogDegree = 1.0 / std::log(static_cast<double>(degree));
+        }
+    }
+
+    // iterations 和 z 为逃逸时间迭代停止时的值，func 为迭代函数
+    template <typename Func>
+    float value(int iterations, std::complex<double> z, const Func& func) const {
+        if (iterations >= maxIterations || invLogDegree == 0) return static_cast<float>(iterations);
+        for (int extra = 0; extra < 64 && std::norm(z) < 1e20; ++extra) {
+            z = func(z);
+            ++iterations;
+        }
+        double logModulus = 0.5 * std::log(std::norm(z));
+        double nu = iterations + 1 - std::log(logModulus / logEscapeRadius) * invLogDegree;
+        // 起点远在逃逸半径之外时 nu 可能为负；溢出得到 NaN 时取 0
+        return static_cast<float>(std::min(static_cast<double>(maxIterations), std::max(0.0, nu)));
+    }
+};
+
+// ==========================================
+// 渲染线程池
+// 所有矩阵生成函数共用一个常驻线程池，线程数、核心绑定可在运行时设置
+// ==========================================
+
+// 渲染线程设置
+struct RenderThreadSettings {
+    int threadCount = 0;     // 工作线程数，0 表示自动（见 defaultRenderThreadCount）
+    bool pinThreads = false; // 是否将每个工作线程绑定到一个 CPU 核心（仅 Linux）
+    bool lowPriority = false; // 工作线程以最低调度优先级运行，只占用空闲的 CPU（后台导出用）
+};
+
+// 本进程实际可用的 CPU 数：考虑 CPU 亲和性（cpuset）和 cgroup 的 CPU 配额，至少为 1
+int defaultRenderThreadCount();
+
+// 修改线程设置，线程池会在空闲时按新设置重建
+void setRenderThreadSettings(const RenderThreadSettings& settings);
+RenderThreadSettings renderThreadSettings();
+
+// 当前实际使用的线程数
+int renderThreadCount();
+
+// 把调用线程的调度优先级降到最低：Linux 上为 SCHED_IDLE（不支持时 nice 19），Windows 上为 IDLE
+void lowerCurrentThreadPriority();
+
+// 常驻线程池。parallelFor 的调用线程也参与计算，因此工作线程数为 threadCount - 1，
+// 并且可以在线程池的任务中再次调用 parallelFor 而不会死锁
+class RenderThreadPool {
+public:
+    explicit RenderThreadPool(const RenderThreadSettings& settings);
+    ~RenderThreadPool();
+    RenderThreadPool(const RenderThreadPool&) = delete;
+    RenderThreadPool& operator=(const RenderThreadPool&) = delete;
+
+    int threadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+    // 对 [0, count) 中的每个下标执行 func，返回时全部执行完毕
+    void parallelFor(int count, const std::function<void(int)>& func);
+
+private:
+    struct Job {
+        const std::function<void(int)>* func;
+        int count;
+        std::atomic<int> next{0};
+        int done = 0; // 已完成的下标数，受 doneMutex 保护
+        std::mutex doneMutex;
+        std::condition_variable doneCondition;
+    };
+
+    void workerLoop(int index);
+    // 执行 job 中已领取的下标 index
+    void runIndex(Job& job, int index);
+
+    std::vector<std::thread> workers;
+    std::deque<Job*> queue;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    bool stopping = false;
+    bool lowPriority = false;
+};
+
+// 当前线程使用的渲染线程池：通常是全局线程池，在 ScopedRenderThreadPool 的作用域内和
+// 其它线程池的工作线程中则是对应的线程池，因此嵌套的 parallelForRows 仍在同一个线程池中执行
+RenderThreadPool& renderThreadPool();
+
+// 在当前线程的作用域内，让 renderThreadPool() 返回 pool，
+// 例如后台导出在低优先级的线程池中渲染，不与交互渲染争抢全局线程池
+class ScopedRenderThreadPool {
+public:
+    explicit ScopedRenderThreadPool(RenderThreadPool& pool);
+    ~ScopedRenderThreadPool();
+    ScopedRenderThreadPool(const ScopedRenderThreadPool&) = delete;
+    ScopedRenderThreadPool& operator=(const ScopedRenderThreadPool&) = delete;
+
+private:
+    RenderThreadPool* previous;
+};
+
+// 在 renderThreadPool() 中执行 parallelFor。执行期间全局线程池即使被 setRenderThreadSettings 替换也不会销毁，
+// 因此界面线程修改线程设置时，其它线程中正在进行的渲染（例如交互预览）不受影响
+void renderParallelFor(int count, const std::function<void(int)>& func);
+
+// 将 [0, rowCount) 行分配给渲染线程池，并行执行 rowFunc(y)
+template <typename RowFunc>
+void parallelForRows(int rowCount, const RowFunc& rowFunc) {
+    std::function<void(int)> func = [&rowFunc](int y) { rowFunc(y); };
+    renderParallelFor(rowCount, func);
+}
+
+// 线程数扩展曲线中的一个点
+struct ThreadScalingSample {
+    int threads;
+    double seconds;
+    double iterationsPerSecond; // 每秒完成的像素迭代次数
+};
+
+// ==========================================
+// 渲染进度与取消
+// ==========================================
+
+/**
+ * 一次渲染的进度报告与取消标志，可在任意线程中调用 cancel()。
+ *
+ * progress 回调收到 [0, 1] 的完成比例，返回 false 表示取消渲染。
+ * 回调在工作线程中调用，但同一时刻只有一个线程在调用；进度每增加 0.1% 左右才回调一次。
+ */
+class RenderControl {
+public:
+    explicit RenderControl(std::function<bool(double)> progress = {})
+        : progress(std::move(progress)) {}
+
+    void cancel() { cancelled = true; }
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+    // 开始一个新阶段，共 totalUnits 个工作单元
+    void begin(long long totalUnits) {
+        std::lock_guard<std::mutex> lock(mutex);
+        total = std::max(1LL, totalUnits);
+        done = 0;
+        reported = -1;
+    }
+
+    // 完成 units 个工作单元
+    void advance(long long units) {
+        if (!progress) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        done += units;
+        long long permille = done * 1000 / total;
+        if (permille == reported) return;
+        reported = permille;
+        if (!progress(static_cast<double>(done) / total)) cancelled = true;
+    }
+
+private:
+    std::function<bool(double)> progress;
+    std::atomic<bool> cancelled{false};
+    std::mutex mutex;
+    long long total = 1;
+    long long done = 0;
+    long long reported = -1;
+};
+
+/**
+ * 逐像素计算 Julia 集的迭代次数，结果写入 rowOut(y) 返回的行（每行 width 个 int）。
+ *
+ * rowOut(y) 对每行恰好调用一次，且在计算该行的线程中调用，
+ * 因此可以在其中按行分配内存（first-touch），绑定核心时内存落在该线程所在的 NUMA 节点。
+ * rowOut(y) 返回 nullptr 的行不计算（例如已从检查点恢复的行）。
+ * control 不为空时按行报告进度，并在取消后跳过剩余的行。
+ */
+template <typename Func, typename RowOut>
+void renderJuliaRows(
+    double realRangeMin, double realRangeMax, double imagRangeMin, double imagRangeMax,
+    int width, int height,
+    const Func& func,
+    int maxIterations,
+    double escapeRadius,
+    const RowOut& rowOut,
+    RenderControl* control = nullptr
+    ) {
+    double scaleX = (realRangeMax - realRangeMin) / width;
+    double scaleY = (imagRangeMax - imagRangeMin) / height;
+    double escapeRadiusSq = escapeRadius * escapeRadius;
+
+    if (control) control->begin(height);
+    parallelForRows(height, [&](int y) {
+        if (control && control->isCancelled()) return;
+        int* out = rowOut(y);
+        if (!out) {
+            if (control) control->advance(1);
+            return;
+        }
+        for (int x = 0; x < width; ++x) {
+            std::complex<double> z(x * scaleX + realRangeMin,
+                                   y * scaleY + imagRangeMin);
+            out[x] = juliaEscapeTime(z, func, maxIterations, escapeRadiusSq);
+        }
+        if (control) control->advance(1);
+    });
+}
+
+/**
+ * 与 renderJuliaRows 相同，同时在同一遍迭代中输出平滑逃逸值（见 SmoothEscape），
+ * 写入 smoothOut(y) 返回的行（每行 width 个 float）。迭代次数与 renderJuliaRows 完全相同。
+ * rowOut(y) 返回 nullptr 的行不计算，此时不调用 smoothOut(y)。
+ */
+template <typename Func, typename RowOut, typename SmoothOut>
+void renderJuliaSmoothRows(
+    double realRangeMin, double realRangeMax, double imagRangeMin, double imagRangeMax,
+    int width, int height,
+    const Func& func,
+    int maxIterations,
+    double escapeRadius,
+    const SmoothEscape& smooth,
+    const RowOut& rowOut,
+    const SmoothOut& smoothOut,
+    RenderControl* control = nullptr
+    ) {
+    double scaleX = (realRangeMax - realRangeMin) / width;
+    double scaleY = (imagRangeMax - imagRangeMin) / height;
+    double escapeRadiusSq = escapeRadius * escapeRadius;
+
+    if (control) control->begin(height);
+    parallelForRows(height, [&](int y) {
+        if (control && control->isCancelled()) return;
+        int* out = rowOut(y);
+        if (!out) {
+            if (control) control->advance(1);
+            return;
+        }
+        float* smoothRow = smoothOut(y);
+        for (int x = 0; x < width; ++x) {
+            std::complex<double> z(x * scaleX + realRangeMin,
+                                   y * scaleY + imagRangeMin);
+            int iterations = 0;
+            while (std::norm(z) < escapeRadiusSq && iterations < maxIterations) {
+                z = func(z);
+                ++iterations;
+            }
+            out[x] = iterations;
+            smoothRow[x] = smooth.value(iterations, z, func);
+        }
+        if (control) control->advance(1);
+    });
+}
+
+// 计算 Julia 集并返回一个二维矩阵，表示迭代了多少次
+// ==========================================
+// 2. generateJuliaMatrix (模板函数必须在头文件中实现)
+// ==========================================
+template <typename Func>
+std::vector<std::vector<int>> generateJuliaMatrix(
+    double realRangeMin, double realRangeMax, double imagRangeMin, double imagRangeMax,
+    int width, int height,
+    const Func& func,
+    int maxIterations,
+    double escapeRadius = 2.0
+    ) {
+    // 每一行由计算它的线程分配（first-touch）
+    std::vector<std::vector<int>> matrix(height);
+    renderJuliaRows(realRangeMin, realRangeMax, imagRangeMin, imagRangeMax, width, height,
+                    func, maxIterations, escapeRadius,
+                    [&](int y) { matrix[y].assign(width, 0); return matrix[y].data(); });
+    return matrix;
+}
+
+// ==========================================
+// 参数平面与交互预览（z^2+c）
+// ==========================================
+
+// z^2+c 从 z 开始的逃逸时间，判定条件与 juliaEscapeTime 相同；Real 为 float 时用于低延迟预览
+template <typename Real>
+inline int quadraticEscapeTime(Real zr, Real zi, Real cr, Real ci, int maxIterations, Real escapeRadiusSq) {
+    Real zr2 = zr * zr, zi2 = zi * zi;
+    int iterations = 0;
+    while (zr2 + zi2 < escapeRadiusSq && iterations < maxIterations) {
+        zi = 2 * zr * zi + ci;
+        zr = zr2 - zi2 + cr;
+        zr2 = zr * zr;
+        zi2 = zi * zi;
+        ++iterations;
+    }
+    return iterations;
+}
+
+/**
+ * z^2+c 的参数平面（Mandelbrot 集）：像素 (x, y) 对应 c = (realMin + x * scaleX, imagMin + y * scaleY)，
+ * 从临界点 0 开始迭代。坐标约定、rowOut 和 control 与 renderJuliaRows 相同，
+ * 因此参数平面上的像素可以直接换算成动力平面使用的常数 c。
+ */
+template <typename RowOut>
+void renderMandelbrotRows(
+    double realRangeMin, double realRangeMax, double imagRangeMin, double imagRangeMax,
+    int width, int height,
+    int maxIterations,
+    double escapeRadius,
+    const RowOut& rowOut,
+    RenderControl* control = nullptr
+    ) {
+    double scaleX = (realRangeMax - realRangeMin) / width;
+    double scaleY = (imagRangeMax - imagRangeMin) / height;
+    double escapeRadiusSq = escapeRadius * escapeRadius;
+
+    if (control) control->begin(height);
+    parallelForRows(height, [&](int y) {
+        if (control && control->isCancelled()) return;
+        int* out = rowOut(y);
+        if (out) {
+            for (int x = 0; x < width; ++x)
+                out[x] = quadraticEscapeTime(0.0, 0.0, x * scaleX + realRangeMin, y * scaleY + imagRangeMin,
+                                             maxIterations, escapeRadiusSq);
+        }
+        if (control) control->advance(1);
+    });
+}
+
+/**
+ * z^2+c 的 Julia 集的低延迟预览，像素坐标与 renderJuliaRows 相同。
+ *
+ * 用单精度迭代，比通用内核快得多，结果只在集合边界附近与双精度不同，只用于交互预览。
+ * 每行开始前检查 control，调用方在参数变化时 cancel() 即可在一行之内停止。
+ */
+template <typename RowOut>
+void renderQuadraticJuliaPreviewRows(
+    std::complex<double> c,
+    double realRangeMin, double realRangeMax, double imagRangeMin, double imagRangeMax,
+    int width, int height,
+    int maxIterations,
+    double escapeRadius,
+    const RowOut& rowOut,
+    RenderControl* control = nullptr
+    ) {
+    const float scaleX = static_cast<float>((realRangeMax - realRangeMin) / width);
+    const float scaleY = static_cast<float>((imagRangeMax - imagRangeMin) / height);
+    const float realMin = static_cast<float>(realRangeMin);
+    const float imagMin = static_cast<float>(imagRangeMin);
+    const float cr = static_cast<float>(c.real()), ci = static_cast<float>(c.imag());
+    const float escapeRadiusSq = static_cast<float>(escapeRadius * escapeRadius);
+
+    if (control) control->begin(height);
+    parallelForRows(height, [&](int y) {
+        if (control && control->isCancelled()) return;
+        int* out = rowOut(y);
+        if (out) {
+            const float zi = y * scaleY + imagMin;
+            for (int x = 0; x < width; ++x)
+                out[x] = quadraticEscapeTime(x * scaleX + realMin, zi, cr, ci, maxIterations, escapeRadiusSq);
+        }
+        if (control) control->advance(1);
+    });
+}
+
+// ==========================================
+// 可续算的逃逸时间渲染
+// ==========================================
+
+// 从第 iterations 次迭代、当前值 z 处继续迭代，返回时 z、iterations 为停止时的值
+template <typename Func>
+inline void continueEscapeTime(std::complex<double>& z, int& iterations, const Func& func,
+                               int maxIterations, double escapeRadiusSq) {
+    while (std::norm(z) < escapeRadiusSq && iterations < maxIterations) {
+        z = func(z);
+        ++iterations;
+    }
+}
+
+/**
+ * 可续算的逃逸时间结果：除迭代次数外，还保存每个像素停止迭代时的 z（每像素额外 16 字节）。
+ *
+ * 之后只提高 maxIterations 和/或 escapeRadius 时，continueJuliaState 从停止处继续：
+ * 未逃逸的像素接着迭代；已逃逸的像素若 |z| 仍不小于新的逃逸半径，则逃逸时刻不变，直接沿用，
+ * 否则（只在提高逃逸半径时出现）也从停止处接着迭代。结果与用新参数从头计算完全相同。
+ */
+struct EscapeTimeState {
+    int maxIterations = 0;
+    double escapeRadius = 0;
+    std::vector<std::vector<int>> iterations;
+    std::vector<std::vector<std::complex<double>>> lastZ;
+
+    bool empty() const { return iterations.empty(); }
+};
+
+// 计算 Julia 集并保存续算所需的状态，迭代次数与 generateJuliaMatrix 相同
+template <typename Func>
+EscapeTimeState generateJuliaState(
+    double realRangeMin, double realRangeMax, double imagRangeMin, double imagRangeMax,
+    int width, int height,
+    const Func& func,
+    int maxIterations,
+    double escapeRadius = 2.0
+    ) {
+    EscapeTimeState state;
+    state.maxIterations = maxIterations;
+    state.escapeRadius = escapeRadius;
+    state.iterations.resize(height);
+    state.lastZ.resize(height);
+
+    double scaleX = (realRangeMax - realRangeMin) / width;
+    double scaleY = (imagRangeMax - imagRangeMin) / height;
+    double escapeRadiusSq = escapeRadius * escapeRadius;
+
+    parallelForRows(height, [&](int y) {
+        // 每一行由计算它的线程分配（first-touch）
+        auto& counts = state.iterations[y];
+        auto& zs = state.lastZ[y];
+        counts.assign(width, 0);
+        zs.resize(width);
+        for (int x = 0; x < width; ++x) {
+            std::complex<double> z(x * scaleX + realRangeMin, y * scaleY + imagRangeMin);
+            continueEscapeTime(z, counts[x], func, maxIterations, escapeRadiusSq);
+            zs[x] = z;
+        }
+    });
+    return state;
+}
+
+/**
+ * 把 state 续算到新的 maxIterations 和 escapeRadius，二者都不能小于 state 中的值，否则抛出 std::invalid_argument。
+ * func 必须与计算 state 时相同。返回实际继续迭代的像素数。
+ */
+template <typename Func>
+long long continueJuliaState(EscapeTimeState& state, const Func& func, int maxIterations, double escapeRadius) {
+    if (maxIterations < state.maxIterations || escapeRadius < state.escapeRadius)
+        throw std::invalid_argument("续算只能提高最大迭代次数和逃逸半径");
+
+    const double escapeRadiusSq = escapeRadius * escapeRadius;
+    std::atomic<long long> continued{0};
+    parallelForRows(static_cast<int>(state.iterations.size()), [&](int y) {
+        auto& counts = state.iterations[y];
+        auto& zs = state.lastZ[y];
+        long long rowContinued = 0;
+        for (size_t x = 0; x < counts.size(); ++x) {
+            if (std::norm(zs[x]) >= escapeRadiusSq || counts[x] >= maxIterations) continue;
+            continueEscapeTime(zs[x], counts[x], func, maxIterations, escapeRadiusSq);
+            ++rowContinued;
+        }
+        continued += rowContinued;
+    });
+
+    state.maxIterations = maxIterations;
+    state.escapeRadius = escapeRadius;
+    return continued;
+}
+
+// 由续算状态中每个像素停止时的 z 计算平滑逃逸值，与 renderJuliaSmoothRows 的结果相同
+template <typename Func>
+std::vector<std::vector<float>> smoothEscapeValues(const EscapeTimeState& state, const Func& func, int degree) {
+    const SmoothEscape smooth(degree, state.maxIterations, state.escapeRadius);
+    std::vector<std::vector<float>> values(state.iterations.size());
+    parallelForRows(static_cast<int>(values.size()), [&](int y) {
+        const auto& iterations = state.iterations[y];
+        const auto& lastZ = state.lastZ[y];
+        values[y].resize(iterations.size());
+        for (size_t x = 0; x < iterations.size(); ++x)
+            values[y][x] = smooth.value(iterations[x], lastZ[x], func);
+    });
+    return values;
+}
+
+// 线程数扩展测试：依次用 1..maxThreads 个线程渲染同一场景并计时，maxThreads 为 0 时取默认线程数
+// 测试结束后恢复原来的线程设置
+template <typename Func>
+std::vector<ThreadScalingSample> measureThreadScaling(
+    double realRangeMin, double realRangeMax, double imagRangeMin, double imagRangeMax,
+    int width, int height,
+    const Func& func,
+    int maxIterations,
+    double escapeRadius = 2.0,
+    int maxThreads = 0
+    ) {
+    const RenderThreadSettings saved = renderThreadSettings();
+    if (maxThreads <= 0) maxThreads = defaultRenderThreadCount();
+
+    std::vector<ThreadScalingSample> samples;
+    for (int threads = 1; threads <= maxThreads; ++threads) {
+        RenderThreadSettings settings = saved;
+        settings.threadCount = threads;
+        setRenderThreadSettings(settings);
+        renderThreadPool(); // 先建好线程池，不计入耗时
+
+        auto start = std::chrono::steady_clock::now();
+        auto matrix = generateJuliaMatrix(realRangeMin, realRangeMax, imagRangeMin, imagRangeMax,
+                                          width, height, func, maxIterations, escapeRadius);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double iterations = 0;
+        for (const auto& row : matrix)
+            for (int count : row)
+                iterations += count;
+        samples.push_back({threads, seconds, seconds > 0 ? iterations / seconds : 0});
+    }
+    setRenderThreadSettings(saved);
+    return samples;
+}
+
+// ==========================================
+// 交互帧的质量控制
+// ==========================================
+
+// 一帧使用的分辨率（正方形边长）和最大迭代次数，以及按当前吞吐量估计的耗时
+struct FrameQuality {
+    int resolution = 0;
+    int maxIterations = 0;
+    double predictedSeconds = 0;
+};
+
+/**
+ * 按帧时间预算选择交互帧的分辨率和最大迭代次数。
+ *
+ * 每次逃逸时间渲染后用 record() 记录像素数、迭代次数之和、达到最大迭代次数的像素数和耗时。
+ * 控制器用指数滑动平均估计吞吐量（每秒完成的工作量，每个像素的工作量为迭代次数加 1，
+ * 加 1 对应每像素的固定开销），并保存最近一帧的迭代分布：
+ * 逃逸像素的平均迭代次数与最大迭代次数无关，未逃逸像素的迭代次数等于最大迭代次数。
+ *
+ * choose() 先按比例降低分辨率，降到 minResolution 仍超出预算时再降低最大迭代次数（不低于 minIterations）。
+ * 还没有记录时返回请求的设置。
+ */
+class FrameQualityController {
+public:
+    void record(long long pixels, long long iterations, long long cappedPixels, int maxIterations, double seconds);
+    FrameQuality choose(int resolution, int maxIterations, double targetSeconds) const;
+
+    bool hasEstimate() const { return workPerSecond > 0; }
+    // 估计的吞吐量：每秒完成的像素迭代次数
+    double throughput() const { return workPerSecond; }
+    // 按最近一帧的迭代分布，估计 resolution x resolution、最大迭代 maxIterations 的耗时
+    double predictSeconds(int resolution, int maxIterations) const;
+
+    int minResolution = 64;
+    int minIterations = 32;
+    double smoothing = 0.5; // 新测量值的权重
+
+private:
+    double workPerSecond = 0;
+    double escapedPerPixel = 0; // 逃逸像素的迭代次数之和 / 像素数
+    double cappedFraction = 0;  // 达到最大迭代次数的像素比例
+};
+
+// 像素 (x, y) 的第 sample 个抖动采样在像素内的偏移，取值 [0, 1)
+// 使用 R2 低差异序列，再按像素坐标做一次哈希旋转，避免相邻像素出现相同的图案
+inline std::pair<double, double> jitterOffset(int x, int y, int sample) {
+    const double a1 = 0.7548776662466927; // 1/phi2
+    const double a2 = 0.5698402909980532; // 1/phi2^2
+    uint32_t h = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u;
+    h ^= h >> 13; h *= 0x5bd1e995u; h ^= h >> 15;
+    double rx = (h & 0xffff) / 65536.0;
+    double ry = (h >> 16) / 65536.0;
+    double u = rx + a1 * (sample + 1);
+    double v = ry + a2 * (sample + 1);
+    return {u - std::floor(u), v - std::floor(v)};
+}
+
+/**
+ * 自适应超采样：只对边缘像素追加抖动采样。
+ *
+ * matrix 是 generateJuliaMatrix 以相同参数得到的每像素单次采样结果。
+ * 若某像素与其 8 邻域的迭代次数之差超过 threshold，则在像素内追加 extraSamples 个抖动采样，
+ * 所有采样经 getColor 上色后在颜色空间中取平均；其余像素直接使用单次采样的颜色。
+ * 颜色为 0xAARRGGBB，写入 pixels，相邻两行间隔 stride 个像素。返回被细化的像素数量。
+ */
+template <typename Func>
+int renderAdaptiveAA(
+    const std::vector<std::vector<int>>& matrix,
+    double realRangeMin, double realRangeMax, double imagRangeMin, double imagRangeMax,
+    const Func& func,
+    int maxIterations,
+    double escapeRadius,
+    const std::function<uint32_t(float)>& getColor,
+    int threshold,
+    int extraSamples,
+    uint32_t* pixels,
+    std::ptrdiff_t stride
+    ) {
+    int height = matrix.size();
+    int width = height > 0 ? matrix[0].size() : 0;
+    if (width == 0 || height == 0) return 0;
+
+    auto red = [](uint32_t c) { return int((c >> 16) & 0xff); };
+    auto green = [](uint32_t c) { return int((c >> 8) & 0xff); };
+    auto blue = [](uint32_t c) { return int(c & 0xff); };
+
+    double scaleX = (realRangeMax - realRangeMin) / width;
+    double scaleY = (imagRangeMax - imagRangeMin) / height;
+    double escapeRadiusSq = escapeRadius * escapeRadius;
+
+    std::atomic<int> refined{0};
+
+    parallelForRows(height, [&](int y) {
+        uint32_t* line = pixels + y * stride;
+        int rowRefined = 0;
+        for (int x = 0; x < width; ++x) {
+            int center = matrix[y][x];
+            bool isEdge = false;
+            for (int dy = -1; dy <= 1 && !isEdge; ++dy) {
+                int ny = y + dy;
+                if (ny < 0 || ny >= height) continue;
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int nx = x + dx;
+                    if (nx < 0 || nx >= width) continue;
+                    if (std::abs(matrix[ny][nx] - center) > threshold) { isEdge = true; break; }
+                }
+            }
+
+            uint32_t base = getColor(center);
+            if (!isEdge || extraSamples <= 0) {
+                line[x] = base;
+                continue;
+            }
+
+            int r = red(base), g = green(base), b = blue(base);
+            for (int s = 0; s < extraSamples; ++s) {
+                auto offset = jitterOffset(x, y, s);
+                std::complex<double> z((x + offset.first) * scaleX + realRangeMin,
+                                       (y + offset.second) * scaleY + imagRangeMin);
+                uint32_t c = getColor(juliaEscapeTime(z, func, maxIterations, escapeRadiusSq));
+                r += red(c); g += green(c); b += blue(c);
+            }
+            int n = extraSamples + 1;
+            line[x] = 0xff000000u | uint32_t(r / n) << 16 | uint32_t(g / n) << 8 | uint32_t(b / n);
+            ++rowRefined;
+        }
+        refined += rowRefined;
+    });
+
+    return refined;
+}
+
+/**
+ * 轨道密度渲染（Buddhabrot / anti-Buddhabrot）。
+ *
+ * 在 [-escapeRadius, escapeRadius]^2 内随机选取 sampleCount 个起点，迭代 func，
+ * 把逃逸轨道（antiBuddhabrot 时为不逃逸的轨道）经过的点累加到视口对应的二维直方图中。
+ * 每个线程使用私有直方图，最后合并，因此不存在共享计数器的竞争。
+ * 私有直方图的计数在 UINT32_MAX 处饱和，合并按 64 位累加，加权后的结果截断到 INT_MAX。
+ * importanceSampling 为 true 时，先用粗网格找出集合边界附近的格子，80% 的起点从这些格子中选取。
+ * 每条轨道按 均匀密度 / 提议密度 加权（起点在边界格内的轨道权重小于 1，其余为 5），
+ * 因此结果的期望与 sampleCount 个均匀起点相同，只是方差更小。
+ * control 不为空时按起点数报告进度，取消后停止采样，返回的结果不完整。
+ * 返回值与 generateJuliaMatrix 形式相同，可直接交给 ColorMap 上色。
+ */
+template <typename Func>
+std::vector<std::vector<int>> generateOrbitDensityMatrix(
+    double realRangeMin, double realRangeMax, double imagRangeMin, double imagRangeMax,
+    int width, int height,
+    const Func& func,
+    int maxIterations,
+    double escapeRadius,
+    long long sampleCount,
+    bool antiBuddhabrot = false,
+    bool importanceSampling = true,
+    uint64_t seed = 1,
+    RenderControl* control = nullptr
+    ) {
+    std::vector<std::vector<int>> matrix(height, std::vector<int>(width));
+    if (width <= 0 || height <= 0 || sampleCount <= 0) return matrix;
+
+    const double escapeRadiusSq = escapeRadius * escapeRadius;
+    const double invScaleX = width / (realRangeMax - realRangeMin);
+    const double invScaleY = height / (imagRangeMax - imagRangeMin);
+
+    // 重要性采样：在起点区域上做粗网格，标记迭代次数与邻格不同的格子为边界格
+    const int gridSize = 64;
+    const double cellSize = 2 * escapeRadius / gridSize;
+    std::vector<int> boundaryCells;
+    std::vector<char> isBoundaryCell(gridSize * gridSize, 0);
+    if (importanceSampling) {
+        std::vector<int> coarse(gridSize * gridSize);
+        for (int gy = 0; gy < gridSize; ++gy)
+            for (int gx = 0; gx < gridSize; ++gx)
+                coarse[gy * gridSize + gx] = juliaEscapeTime(
+                    std::complex<double>((gx + 0.5) * cellSize - escapeRadius, (gy + 0.5) * cellSize - escapeRadius),
+                    func, maxIterations, escapeRadiusSq);
+        for (int gy = 0; gy < gridSize; ++gy) {
+            for (int gx = 0; gx < gridSize; ++gx) {
+                int center = coarse[gy * gridSize + gx];
+                bool isBoundary = false;
+                for (int dy = -1; dy <= 1 && !isBoundary; ++dy)
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        int nx = gx + dx, ny = gy + dy;
+                        if (nx < 0 || ny < 0 || nx >= gridSize || ny >= gridSize) continue;
+                        if (coarse[ny * gridSize + nx] != center) { isBoundary = true; break; }
+                    }
+                if (isBoundary) {
+                    boundaryCells.push_back(gy * gridSize + gx);
+                    isBoundaryCell[gy * gridSize + gx] = 1;
+                }
+            }
+        }
+    }
+
+    // 起点的提议密度为 0.2 * 均匀密度 + 0.8 * 边界格上的均匀密度，按起点所在的格子分两类计数，合并时再乘以权重
+    const double boundaryFraction = 0.8;
+    const double boundaryWeight = boundaryCells.empty() ? 1.0
+        : 1.0 / ((1 - boundaryFraction) + boundaryFraction * gridSize * gridSize / boundaryCells.size());
+    const double otherWeight = boundaryCells.empty() ? 1.0 : 1.0 / (1 - boundaryFraction);
+
+    // 每个分片一个线程，各自持有私有直方图：前 width * height 项是起点在边界格内的轨道，后面是其余轨道
+    const int shardCount = renderThreadCount();
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    std::vector<std::vector<uint32_t>> histograms(shardCount);
+    const long long progressChunk = 4096;
+    if (control) control->begin((sampleCount + progressChunk - 1) / progressChunk);
+
+    parallelForRows(shardCount, [&](int shard) {
+        std::vector<uint32_t>& hist = histograms[shard];
+        hist.assign(boundaryCells.empty() ? pixelCount : 2 * pixelCount, 0);
+
+        std::mt19937_64 rng(seed * 0x9E3779B97F4A7C15ull + shard);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        std::vector<std::complex<double>> orbit(maxIterations);
+
+        long long begin = sampleCount * shard / shardCount;
+        long long end = sampleCount * (shard + 1) / shardCount;
+        for (long long s = begin; s < end; ++s) {
+            if ((s - begin) % progressChunk == 0 && s != begin && control) {
+                if (control->isCancelled()) return;
+                control->advance(1);
+            }
+            std::complex<double> z;
+            if (!boundaryCells.empty() && unit(rng) < boundaryFraction) {
+                int cell = boundaryCells[static_cast<size_t>(unit(rng) * boundaryCells.size()) % boundaryCells.size()];
+                z = {((cell % gridSize) + unit(rng)) * cellSize - escapeRadius,
+                     ((cell / gridSize) + unit(rng)) * cellSize - escapeRadius};
+            }
+            else {
+                z = {(2 * unit(rng) - 1) * escapeRadius, (2 * unit(rng) - 1) * escapeRadius};
+            }
+            size_t histOffset = 0;
+            if (!boundaryCells.empty()) {
+                int gx = std::min(gridSize - 1, static_cast<int>((z.real() + escapeRadius) / cellSize));
+                int gy = std::min(gridSize - 1, static_cast<int>((z.imag() + escapeRadius) / cellSize));
+                histOffset = isBoundaryCell[gy * gridSize + gx] ? 0 : pixelCount;
+            }
+
+            int iterations = 0;
+            while (std::norm(z) < escapeRadiusSq && iterations < maxIterations) {
+                z = func(z);
+                orbit[iterations++] = z;
+            }
+            bool escaped = iterations < maxIterations;
+            if (escaped == antiBuddhabrot) continue;
+
+            for (int i = 0; i < iterations; ++i) {
+                int px = static_cast<int>(std::floor((orbit[i].real() - realRangeMin) * invScaleX));
+                int py = static_cast<int>(std::floor((orbit[i].imag() - imagRangeMin) * invScaleY));
+                if (px < 0 || py < 0 || px >= width || py >= height) continue;
+                // 32 位计数饱和而不回绕，合并时按 64 位累加
+                uint32_t& bin = hist[histOffset + static_cast<size_t>(py) * width + px];
+                if (bin != UINT32_MAX) ++bin;
+            }
+        }
+    });
+    if (control && control->isCancelled()) return matrix;
+
+    // 合并各线程的直方图并加权
+    parallelForRows(height, [&](int y) {
+        for (int x = 0; x < width; ++x) {
+            const size_t i = static_cast<size_t>(y) * width + x;
+            uint64_t boundaryCount = 0, otherCount = 0;
+            for (const auto& hist : histograms) {
+                boundaryCount += hist[i];
+                if (hist.size() > pixelCount) otherCount += hist[pixelCount + i];
+            }
+            double sum = boundaryWeight * boundaryCount + otherWeight * otherCount;
+            matrix[y][x] = static_cast<int>(std::min<double>(std::round(sum), INT_MAX));
+        }
+    });
+
+    return matrix;
+}
+
+// 生成 Mandelbrot set
+std::vector<std::vector<int>> generateMandelbrotMatrix(int width, int height, int n, const std::complex<double>& c, int maxIterations);
+
+using Complex = std::complex<double>;
+// 解析单个复数
+inline Complex parseComplexCoeff(std::string s) {
+    s.erase(std::remove_if(s.begin(), s.end(), ::isspace), s.end());
+    if (s.empty()) return {1, 0};
+
+    double signMultiplier = 1.0;
+    if (s.front() == '-') { signMultiplier = -1.0; s.erase(0, 1); }
+    else if (s.front() == '+') { s.erase(0, 1); }
+
+    if (s.empty()) return {1.0 * signMultiplier, 0};
+
+    // 去括号
+    if (s.front() == '(' && s.back() == ')') s = s.substr(1, s.length() - 2);
+
+    // 无 'i' 视为纯实数
+    if (s.find('i') == std::string::npos) {
+        try { return {std::stod(s) * signMultiplier, 0}; } catch (...) { return {0,0}; }
+    }
+
+    s.pop_back(); // remove 'i'
+
+    // 寻找分割点
+    size_t splitPos = std::string::npos;
+    for (int i = static_cast<int>(s.length()) - 1; i >= 0; --i) {
+        char c = s[i];
+        // 排除科学计数法的 e- 或 E-
+        if ((c == '+' || c == '-') && !(i > 0 && (s[i-1] == 'e' || s[i-1] == 'E'))) {
+            if (i == 0) {} else { splitPos = i; }
+            break;
+        }
+    }
+
+    double real = 0, imag = 0;
+    try {
+        if (splitPos == std::string::npos) imag = std::stod(s);
+        else {
+            real = std::stod(s.substr(0, splitPos));
+            imag = std::stod(s.substr(splitPos));
+        }
+    } catch (...) { throw std::invalid_argument("解析复数失败"); }
+
+    return {real * signMultiplier, imag * signMultiplier};
+};
+
+// 解析复数多项式字符串，返回系数向量，coeffs[k] 为 z^k 的系数
+inline std::vector<std::complex<double>> parsePolynomialCoeffs(const std::string& input) {
+    using Complex = std::complex<double>;
+
+    std::vector<std::pair<int, Complex>> terms;
+    int maxExp = 0;
+
+    std::regex termRegex(R"(([+-]?\s*(?:\([^\)]+\)|[\d\.]+)?)\s*(z)?(?:\^(\d+))?)");
+
+    auto begin = std::sregex_iterator(input.begin(), input.end(), termRegex);
+    auto end = std::sregex_iterator();
+
+    for (std::sregex_iterator i = begin; i != end; ++i) {
+        std::smatch match = *i;
+        std::string fullMatch = match.str();
+
+        // 基础空白检查
+        if (fullMatch.empty() || std::all_of(fullMatch.begin(), fullMatch.end(), ::isspace)) continue;
+
+        std::string coeffStr = match[1].str();
+        bool hasX = match[2].matched;
+        std::string expStr = match[3].str();
+
+        // 修复逻辑：解决 "x^2 + -x" 中间的 "+" 被识别为常数 1 的问题。
+        // 如果这一项没有 x (看起来像常数)，但系数部分其实不包含任何有效数字内容
+        // (没有数字、小数点、i、右括号)，说明它只是一个被正则孤立出来的连接符。
+        if (!hasX) {
+            bool hasEffectiveContent = false;
+            for (char c : coeffStr) {
+                // 只要包含数字、小数点、虚数单位i、或者右括号(表示复数结束)，就是有效常数
+                if (isdigit(c) || c == '.' || c == 'i' || c == ')') {
+                    hasEffectiveContent = true;
+                    break;
+                }
+            }
+            // 如果只有 + / - 或空格，跳过该匹配
+            if (!hasEffectiveContent) continue;
+        }
+
+        Complex coeff = parseComplexCoeff(coeffStr);
+        int exponent = 0;
+
+        if (hasX) {
+            exponent = expStr.empty() ? 1 : std::stoi(expStr);
+        }
+
+        if (exponent > maxExp) maxExp = exponent;
+        terms.push_back({exponent, coeff});
+    }
+
+    if (terms.empty()) throw std::invalid_argument("未检测到有效的多项式项");
+
+    std::vector<Complex> coeffs(maxExp + 1, {0, 0});
+    for (const auto& term : terms) coeffs[term.first] += term.second;
+
+    return coeffs;
+}
+
+// 由系数向量构建多项式的字符串表示
+inline std::string formatPolynomial(const std::vector<std::complex<double>>& coeffs) {
+    using Complex = std::complex<double>;
+
+    std::stringstream ss;
+    bool isFirst = true;
+    for (int i = static_cast<int>(coeffs.size()) - 1; i >= 0; --i) {
+        Complex c = coeffs[i];
+        if (std::abs(c.real()) < 1e-10 && std::abs(c.imag()) < 1e-10) {
+            if (i == 0 && isFirst) ss << "0";
+            continue;
+        }
+
+        if (!isFirst) ss << " + ";
+
+        std::string coeffStr;
+        if (std::abs(c.imag()) < 1e-10) {
+            if (i > 0 && std::abs(c.real() - 1.0) < 1e-10) coeffStr = "";
+            else if (i > 0 && std::abs(c.real() + 1.0) < 1e-10) coeffStr = "-";
+            else { std::stringstream temp; temp << c.real(); coeffStr = temp.str(); }
+        } else if (std::abs(c.real()) < 1e-10) {
+            std::stringstream temp;
+            if (std::abs(c.imag() - 1.0) < 1e-10) temp << "i";
+            else if (std::abs(c.imag() + 1.0) < 1e-10) temp << "-i";
+            else temp << c.imag() << "i";
+            coeffStr = temp.str();
+        } else {
+            std::stringstream temp; temp << "(" << c.real() << (c.imag()>=0?"+":"") << c.imag() << "i)";
+            coeffStr = temp.str();
+        }
+        ss << coeffStr;
+        if (i > 0) { ss << "z"; if (i > 1) ss << "^" << i; }
+        isFirst = false;
+    }
+    // 将 + -x 替换为-x
+    auto ss_str = std::regex_replace(ss.str(), std::regex("\\+ \\-"), "- ");
+    return ss_str;
+}
+
+// 由字符串生成lambda// 必须定义在头文件中，以便编译器推导 auto 返回类型
+// inline 关键字防止多个 cpp 包含该头文件时出现 "重定义" 错误
+/**
+ * 解析复数多项式字符串并返回一个高性能求值 Lambda。
+ *
+ * 输入格式示例: "(1+2i)x^3 + 4x^2 + (0-3i)x + 5"
+ * 优化策略:
+ * 1. 预解析为系数向量，Lambda 内部无字符串操作。
+ * 2. Lambda 内部使用霍纳法则 (Horner's Method)。
+ *
+ * 返回一个pair(lambda, str)
+ * 一个可执行的函数和这个函数的字符串表示
+ */
+inline std::pair<std::function<std::complex<double>(std::complex<double>)>, std::string>
+getPolynomialLambda(const std::string& input) {
+    using Complex = std::complex<double>;
+
+    std::vector<Complex> coeffs = parsePolynomialCoeffs(input);
+    auto ss_str = formatPolynomial(coeffs);
+
+    // 4. 返回 Lambda
+    auto lambda = [coeffs](Complex z) -> Complex {
+        if (coeffs.empty()) return {0,0};
+        Complex result = coeffs.back();
+        for (int i = static_cast<int>(coeffs.size()) - 2; i >= 0; --i) {
+            result = result * z + coeffs[i];
+        }
+        return result;
+    };
+
+    return {lambda, ss_str};
+}
+
+
+// 有理函数 P(z)/Q(z) 的系数表示，denominator 为空时表示普通多项式
+struct ParsedFunction {
+    std::vector<std::complex<double>> numerator;
+    std::vector<std::complex<double>> denominator;
+    std::string str; // 函数的字符串表示
+
+    bool isPolynomial() const { return denominator.empty(); }
+};
+
+// 霍纳法则求多项式的值
+inline std::complex<double> evalPolynomial(const std::vector<std::complex<double>>& coeffs, std::complex<double> z) {
+    if (coeffs.empty()) return {0,0};
+    std::complex<double> result = coeffs.back();
+    for (int i = static_cast<int>(coeffs.size()) - 2; i >= 0; --i) {
+        result = result * z + coeffs[i];
+    }
+    return result;
+}
+
+// 有理函数在 z 处的值，分母接近 0 时返回一个很大的数
+inline std::complex<double> evalRational(const std::vector<std::complex<double>>& P,
+                                         const std::vector<std::complex<double>>& Q,
+                                         std::complex<double> z) {
+    if (Q.empty()) return evalPolynomial(P, z);
+    auto de = evalPolynomial(Q, z);
+    if (std::norm(de) < 0.000001)
+        return std::complex(10000000.0, 0.0);
+    return evalPolynomial(P, z) / de;
+}
+
+// 由系数构建有理函数的字符串表示
+inline std::string formatRationalFunction(const std::vector<std::complex<double>>& P,
+                                          const std::vector<std::complex<double>>& Q) {
+    if (Q.empty()) return formatPolynomial(P);
+    return "(" + formatPolynomial(P) + ") / (" + formatPolynomial(Q) + ")";
+}
+
+// 解析一个有理函数 P/Q（没有 / 时为普通多项式），得到系数表示
+inline ParsedFunction parseRationalFunction(const std::string& input) {
+    ParsedFunction f;
+    if (input.find('/') != std::string::npos) {
+        std::regex pattern(R"((.*)/(.*))");
+        std::smatch matches;
+        std::regex_match(input, matches, pattern);
+
+        std::string P_str = matches[1].str();
+        std::string Q_str = matches[2].str();
+
+        // 去除字符串两端的空格
+        P_str = std::regex_replace(P_str, std::regex(R"(^\s+|\s+$)"), "");
+        Q_str = std::regex_replace(Q_str, std::regex(R"(^\s+|\s+$)"), "");
+
+        // 去除左右两端的括号
+        std::regex bracketPattern(R"(^\((.*)\)$)");
+        std::smatch bracketMatches;
+
+        if (std::regex_match(P_str, bracketMatches, bracketPattern) && bracketMatches.size() == 2) {
+            P_str = bracketMatches[1].str();
+        }
+
+        if (std::regex_match(Q_str, bracketMatches, bracketPattern) && bracketMatches.size() == 2) {
+            Q_str = bracketMatches[1].str();
+        }
+
+        f.numerator = parsePolynomialCoeffs(P_str);
+        f.denominator = parsePolynomialCoeffs(Q_str);
+    }
+    else{
+        // 如果没有 / fallback回普通多项式
+        f.numerator = parsePolynomialCoeffs(input);
+    }
+    f.str = formatRationalFunction(f.numerator, f.denominator);
+    return f;
+}
+
+// 函数在无穷远处的次数：分子次数减分母次数（忽略接近 0 的高次系数），用于平滑逃逸值
+inline int escapeDegree(const ParsedFunction& f) {
+    auto degree = [](const std::vector<std::complex<double>>& coeffs) {
+        int d = static_cast<int>(coeffs.size()) - 1;
+        while (d > 0 && std::abs(coeffs[d]) < 1e-10) --d;
+        return d;
+    };
+    return degree(f.numerator) - (f.isPolynomial() ? 0 : degree(f.denominator));
+}
+
+// 由系数表示生成求值 lambda
+inline std::function<std::complex<double>(std::complex<double>)> makeFunctionLambda(const ParsedFunction& f) {
+    if (f.isPolynomial()) {
+        auto coeffs = f.numerator;
+        return [coeffs](Complex z) -> Complex { return evalPolynomial(coeffs, z); };
+    }
+    auto P = f.numerator;
+    auto Q = f.denominator;
+    return [P, Q](Complex z) -> Complex { return evalRational(P, Q, z); };
+}
+
+// 调用getPolynomialLambda解析一个有理函数
+inline std::pair<std::function<std::complex<double>(std::complex<double>)>, std::string>
+getRationalFunctionLambda(const std::string& input) {
+    auto f = parseRationalFunction(input);
+    return {makeFunctionLambda(f), f.str};
+}
+
+
+// 参数图集的布局：columns x rows 个 cellSize 像素的缩略图，
+// 第 (col, row) 格把分子中 z^coeffIndex 的系数替换为参数平面上对应的值
+struct AtlasLayout {
+    int columns = 16;
+    int rows = 16;
+    int cellSize = 64;
+    int coeffIndex = 0; // 默认变化常数项，即 z^2+c 中的 c
+    double paramRealMin = -1.5, paramRealMax = 1.5;
+    double paramImagMin = -1.5, paramImagMax = 1.5;
+};
+
+// 图集第 (col, row) 格对应的参数值（取格子中心）
+inline std::complex<double> atlasCellParameter(const AtlasLayout& layout, int col, int row) {
+    return {layout.paramRealMin + (col + 0.5) * (layout.paramRealMax - layout.paramRealMin) / layout.columns,
+            layout.paramImagMin + (row + 0.5) * (layout.paramImagMax - layout.paramImagMin) / layout.rows};
+}
+
+// 将 f 分子中 z^coeffIndex 的系数替换为 value
+inline ParsedFunction withCoefficient(ParsedFunction f, int coeffIndex, std::complex<double> value) {
+    if (static_cast<int>(f.numerator.size()) <= coeffIndex)
+        f.numerator.resize(coeffIndex + 1, {0, 0});
+    f.numerator[coeffIndex] = value;
+    f.str = formatRationalFunction(f.numerator, f.denominator);
+    return f;
+}
+
+/**
+ * 批量渲染参数图集：一次生成 columns x rows 个 Julia 缩略图。
+ *
+ * 每个缩略图都绘制 [viewRealMin, viewRealMax] x [viewImagMin, viewImagMax] 范围，
+ * 所用函数为 withCoefficient(f, layout.coeffIndex, atlasCellParameter(layout, col, row))。
+ * 所有缩略图的像素行作为一个整体交给线程池，小图不会让线程空闲。
+ * 返回 (rows * cellSize) x (columns * cellSize) 的迭代矩阵。
+ */
+inline std::vector<std::vector<int>> generateParameterAtlas(
+    const ParsedFunction& f,
+    const AtlasLayout& layout,
+    double viewRealMin, double viewRealMax, double viewImagMin, double viewImagMax,
+    int maxIterations,
+    double escapeRadius = 2.0
+    ) {
+    const int cell = layout.cellSize;
+    const int width = layout.columns * cell;
+    const int height = layout.rows * cell;
+    std::vector<std::vector<int>> matrix(height, std::vector<int>(width));
+
+    // 预先为每一格生成系数
+    std::vector<ParsedFunction> cellFuncs;
+    cellFuncs.reserve(layout.columns * layout.rows);
+    for (int row = 0; row < layout.rows; ++row)
+        for (int col = 0; col < layout.columns; ++col)
+            cellFuncs.push_back(withCoefficient(f, layout.coeffIndex, atlasCellParameter(layout, col, row)));
+
+    double scaleX = (viewRealMax - viewRealMin) / cell;
+    double scaleY = (viewImagMax - viewImagMin) / cell;
+    double escapeRadiusSq = escapeRadius * escapeRadius;
+
+    parallelForRows(height, [&](int y) {
+        const int row = y / cell;
+        const int localY = y % cell;
+        for (int col = 0; col < layout.columns; ++col) {
+            const ParsedFunction& g = cellFuncs[row * layout.columns + col];
+            auto func = [&g](Complex z) { return evalRational(g.numerator, g.denominator, z); };
+            int* out = matrix[y].data() + col * cell;
+            for (int x = 0; x < cell; ++x) {
+                std::complex<double> z(x * scaleX + viewRealMin,
+                                       localY * scaleY + viewImagMin);
+                out[x] = juliaEscapeTime(z, func, maxIterations, escapeRadiusSq);
+            }
+        }
+    });
+
+    return matrix;
+}
+
+
+/**
+ * 活跃像素压缩（波前）迭代内核，适用于 maxIterations 很大的场景。
+ *
+ * 像素按 batchPixels 个一批交给线程池。每批像素以 chunkIterations 次迭代为一轮：
+ * 一轮结束后写出已逃逸像素的迭代次数，把仍未逃逸的像素压缩到数组前部，
+ * 之后的计算量只与仍活跃的像素数有关，而不是由整块中最慢的像素决定。
+ * 多项式按实部/虚部分开的数组做霍纳迭代，内层循环对所有活跃像素执行同一操作，便于编译器向量化；
+ * 有理函数使用通用的 func 路径。结果与 generateJuliaMatrix 逐像素一致。
+ * 结果写入 rowOut(y) 返回的行，rowOut 可能在多个线程中对同一行调用，必须每次返回相同的指针。
+ */
+template <typename RowOut>
+void renderJuliaWavefrontRows(
+    double realRangeMin, double realRangeMax, double imagRangeMin, double imagRangeMax,
+    int width, int height,
+    const ParsedFunction& f,
+    int maxIterations,
+    double escapeRadius,
+    const RowOut& rowOut,
+    RenderControl* control = nullptr,
+    int chunkIterations = 64,
+    int batchPixels = 4096
+    ) {
+    if (width <= 0 || height <= 0) return;
+
+    const double scaleX = (realRangeMax - realRangeMin) / width;
+    const double scaleY = (imagRangeMax - imagRangeMin) / height;
+    const double escapeRadiusSq = escapeRadius * escapeRadius;
+    const long long pixelCount = static_cast<long long>(width) * height;
+    const int batchCount = static_cast<int>((pixelCount + batchPixels - 1) / batchPixels);
+    chunkIterations = std::max(1, chunkIterations);
+
+    // 多项式系数的实部、虚部
+    const bool polynomial = f.isPolynomial();
+    const int degree = static_cast<int>(f.numerator.size()) - 1;
+    std::vector<double> coeffRe, coeffIm;
+    for (const auto& c : f.numerator) {
+        coeffRe.push_back(c.real());
+        coeffIm.push_back(c.imag());
+    }
+    auto func = makeFunctionLambda(f);
+
+    if (control) control->begin(batchCount);
+    parallelForRows(batchCount, [&](int batch) {
+        if (control && control->isCancelled()) return;
+        const long long begin = static_cast<long long>(batch) * batchPixels;
+        const int count = static_cast<int>(std::min<long long>(batchPixels, pixelCount - begin));
+
+        // 活跃像素：像素下标、z 的实部和虚部、本轮中的逃逸次数（-1 表示未逃逸）
+        std::vector<long long> index(count);
+        std::vector<double> zr(count), zi(count);
+        std::vector<int> escapedAt(count);
+        for (int i = 0; i < count; ++i) {
+            long long p = begin + i;
+            int x = static_cast<int>(p % width), y = static_cast<int>(p / width);
+            index[i] = p;
+            zr[i] = x * scaleX + realRangeMin;
+            zi[i] = y * scaleY + imagRangeMin;
+        }
+
+        int active = count;
+        int base = 0; // 所有活跃像素都已迭代了 base 次
+        while (active > 0 && base < maxIterations) {
+            const int k = std::min(chunkIterations, maxIterations - base);
+            std::fill(escapedAt.begin(), escapedAt.begin() + active, -1);
+
+            if (polynomial) {
+                for (int j = 0; j < k; ++j) {
+                    // 先检查是否逃逸，再迭代一次；已逃逸的像素继续迭代但不再记录
+                    for (int i = 0; i < active; ++i) {
+                        double re = zr[i], im = zi[i];
+                        bool escapes = re * re + im * im >= escapeRadiusSq;
+                        escapedAt[i] = (escapedAt[i] < 0 && escapes) ? base + j : escapedAt[i];
+                        double rr = coeffRe[degree], ri = coeffIm[degree];
+                        for (int d = degree - 1; d >= 0; --d) {
+                            double t = rr * re - ri * im + coeffRe[d];
+                            ri = rr * im + ri * re + coeffIm[d];
+                            rr = t;
+                        }
+                        zr[i] = rr;
+                        zi[i] = ri;
+                    }
+                }
+                // 本轮最后一次迭代之后的检查留到下一轮开始；若已到 maxIterations 则无需检查
+            }
+            else {
+                for (int i = 0; i < active; ++i) {
+                    std::complex<double> z(zr[i], zi[i]);
+                    for (int j = 0; j < k; ++j) {
+                        if (std::norm(z) >= escapeRadiusSq) { escapedAt[i] = base + j; break; }
+                        z = func(z);
+                    }
+                    zr[i] = z.real();
+                    zi[i] = z.imag();
+                }
+            }
+            base += k;
+
+            // 写出已逃逸的像素，并把未逃逸的像素压缩到前部
+            int kept = 0;
+            for (int i = 0; i < active; ++i) {
+                if (escapedAt[i] >= 0) {
+                    rowOut(static_cast<int>(index[i] / width))[index[i] % width] = escapedAt[i];
+                    continue;
+                }
+                index[kept] = index[i];
+                zr[kept] = zr[i];
+                zi[kept] = zi[i];
+                ++kept;
+            }
+            active = kept;
+        }
+
+        // 迭代到 maxIterations 仍未逃逸
+        for (int i = 0; i < active; ++i)
+            rowOut(static_cast<int>(index[i] / width))[index[i] % width] = base;
+        if (control) control->advance(1);
+    });
+}
+
+// 以波前内核计算 Julia 集并返回二维矩阵，参数见 renderJuliaWavefrontRows
+inline std::vector<std::vector<int>> generateJuliaMatrixWavefront(
+    double realRangeMin, double realRangeMax, double imagRangeMin, double imagRangeMax,
+    int width, int height,
+    const ParsedFunction& f,
+    int maxIterations,
+    double escapeRadius = 2.0,
+    int chunkIterations = 64,
+    int batchPixels = 4096
+    ) {
+    std::vector<std::vector<int>> matrix(height, std::vector<int>(width));
+    renderJuliaWavefrontRows(realRangeMin, realRangeMax, imagRangeMin, imagRangeMax, width, height,
+                             f, maxIterations, escapeRadius,
+                             [&](int y) { return matrix[y].data(); },
+                             nullptr, chunkIterations, batchPixels);
+    return matrix;
+}
+
+
+// ==========================================
+// 对称性检测与镜像渲染
+// ==========================================
+
+// 函数的对称性
+// 若 f(ωz) = ω^m f(z) 且 |ω| = 1，则 z 与 ωz 的轨道模长始终相同，逃逸次数也相同；
+// 若所有系数为实数，则 f(conj z) = conj f(z)，Julia 集关于实轴对称
+struct FunctionSymmetry {
+    bool conjugate = false; // 关于实轴对称
+    int rotationOrder = 1;  // n 重旋转对称；0 表示对任意旋转对称（如单项式）
+
+    bool hasRotation(int n) const { return rotationOrder == 0 || rotationOrder % n == 0; }
+    bool any() const { return conjugate || hasRotation(2); }
+};
+
+// 由分子、分母的系数分析对称性：
+// 非零项的指数两两之差的最大公约数即为旋转对称的阶数（分子、分母分别计算后再取公约数）
+inline FunctionSymmetry analyzeSymmetry(const ParsedFunction& f) {
+    const double eps = 1e-12;
+    auto isZero = [eps](std::complex<double> c) { return std::abs(c.real()) < eps && std::abs(c.imag()) < eps; };
+    auto gcd = [](int a, int b) { while (b) { int t = a % b; a = b; b = t; } return a; };
+
+    FunctionSymmetry sym;
+    sym.conjugate = true;
+    int order = 0;
+    for (const auto* coeffs : {&f.numerator, &f.denominator}) {
+        int first = -1;
+        for (int k = 0; k < static_cast<int>(coeffs->size()); ++k) {
+            const auto& c = (*coeffs)[k];
+            if (isZero(c)) continue;
+            if (std::abs(c.imag()) >= eps) sym.conjugate = false;
+            if (first < 0) first = k;
+            else order = gcd(order, k - first);
+        }
+    }
+    sym.rotationOrder = order;
+    return sym;
+}
+
+// 对称性的文字描述
+inline std::string describeSymmetry(const FunctionSymmetry& sym) {
+    std::string s;
+    if (sym.rotationOrder == 0) s = "任意旋转对称";
+    else if (sym.rotationOrder > 1) s = std::to_string(sym.rotationOrder) + " 重旋转对称";
+    if (sym.conjugate) s += (s.empty() ? "" : "、") + std::string("关于实轴对称");
+    return s.empty() ? "无对称性" : s;
+}
+
+/**
+ * 利用函数对称性的逃逸时间渲染。
+ *
+ * 对称变换中只有 z -> -z、z -> ±iz（要求像素为正方形）和共轭能把像素网格精确映射到网格上，
+ * 因此只使用这几种。对每个像素求出它在对称群下落在网格内的所有像点，
+ * 只有下标最小的像素（基本区域）真正迭代，其余像素直接复制。
+ * 视口关于原点或实轴对称时，默认函数 z^2+c 约可省去一半的计算。
+ * 结果写入 rowOut(y) 返回的行，rowOut 可能在多个线程中对同一行调用，必须每次返回相同的指针。
+ * computedPixels 不为空时返回实际迭代的像素数。
+ */
+template <typename RowOut>
+void renderJuliaSymmetricRows(
+    double realRangeMin, double realRangeMax, double imagRangeMin, double imagRangeMax,
+    int width, int height,
+    const ParsedFunction& f,
+    int maxIterations,
+    double escapeRadius,
+    const RowOut& rowOut,
+    RenderControl* control = nullptr,
+    long long* computedPixels = nullptr
+    ) {
+    const double scaleX = (realRangeMax - realRangeMin) / width;
+    const double scaleY = (imagRangeMax - imagRangeMin) / height;
+    const double escapeRadiusSq = escapeRadius * escapeRadius;
+    auto func = makeFunctionLambda(f);
+
+    // 可用的对称变换 (re, im) -> (a*re + b*im, c*re + d*im)
+    struct Transform { int a, b, c, d; };
+    std::vector<Transform> transforms;
+    const FunctionSymmetry sym = analyzeSymmetry(f);
+    const bool squarePixels = std::abs(scaleX - scaleY) <= 1e-12 * std::abs(scaleX);
+    std::vector<Transform> rotations = {{1, 0, 0, 1}};
+    if (sym.hasRotation(2)) rotations.push_back({-1, 0, 0, -1});
+    if (sym.hasRotation(4) && squarePixels) {
+        rotations.push_back({0, -1, 1, 0});  // iz
+        rotations.push_back({0, 1, -1, 0});  // -iz
+    }
+    for (const auto& r : rotations) {
+        if (r.a != 1 || r.d != 1) transforms.push_back(r);
+        // 共轭再旋转：(re, -im) 之后应用 r
+        if (sym.conjugate) transforms.push_back({r.a, -r.b, r.c, -r.d});
+    }
+
+    // 像素 (x, y) 的对称像中下标最小的网格像素
+    auto sourceOf = [&](int x, int y) -> long long {
+        long long best = static_cast<long long>(y) * width + x;
+        const double re = x * scaleX + realRangeMin;
+        const double im = y * scaleY + imagRangeMin;
+        for (const auto& t : transforms) {
+            double gx = (t.a * re + t.b * im - realRangeMin) / scaleX;
+            double gy = (t.c * re + t.d * im - imagRangeMin) / scaleY;
+            double rx = std::round(gx), ry = std::round(gy);
+            if (std::abs(gx - rx) > 1e-6 || std::abs(gy - ry) > 1e-6) continue;
+            if (rx < 0 || ry < 0 || rx >= width || ry >= height) continue;
+            best = std::min(best, static_cast<long long>(ry) * width + static_cast<long long>(rx));
+        }
+        return best;
+    };
+
+    // 第一遍：只计算基本区域内的像素
+    std::atomic<long long> computed{0};
+    if (control) control->begin(height);
+    parallelForRows(height, [&](int y) {
+        if (control && control->isCancelled()) return;
+        int* out = rowOut(y);
+        long long rowComputed = 0;
+        for (int x = 0; x < width; ++x) {
+            if (!transforms.empty() && sourceOf(x, y) != static_cast<long long>(y) * width + x) continue;
+            std::complex<double> z(x * scaleX + realRangeMin,
+                                   y * scaleY + imagRangeMin);
+            out[x] = juliaEscapeTime(z, func, maxIterations, escapeRadiusSq);
+            ++rowComputed;
+        }
+        computed += rowComputed;
+        if (control) control->advance(1);
+    });
+
+    // 第二遍：镜像/旋转复制其余像素
+    if (!transforms.empty() && !(control && control->isCancelled())) {
+        parallelForRows(height, [&](int y) {
+            int* out = rowOut(y);
+            for (int x = 0; x < width; ++x) {
+                long long src = sourceOf(x, y);
+                if (src != static_cast<long long>(y) * width + x)
+                    out[x] = rowOut(static_cast<int>(src / width))[src % width];
+            }
+        });
+    }
+
+    if (computedPixels) *computedPixels = computed;
+}
+
+// 利用对称性计算 Julia 集并返回二维矩阵，参数见 renderJuliaSymmetricRows
+inline std::vector<std::vector<int>> generateJuliaMatrixSymmetric(
+    double realRangeMin, double realRangeMax, double imagRangeMin, double imagRangeMax,
+    int width, int height,
+    const ParsedFunction& f,
+    int maxIterations,
+    double escapeRadius = 2.0,
+    long long* computedPixels = nullptr
+    ) {
+    std::vector<std::vector<int>> matrix(height, std::vector<int>(width));
+    renderJuliaSymmetricRows(realRangeMin, realRangeMax, imagRangeMin, imagRangeMax, width, height,
+                             f, maxIterations, escapeRadius,
+                             [&](int y) { return matrix[y].data(); },
+                             nullptr, computedPixels);
+    return matrix;
+}
+
+// ==========================================
+// 区间认证的逃逸时间渲染
+// ==========================================
+
+// 复平面上的圆盘区域 |z - center| <= radius
+struct ComplexDisc {
+    std::complex<double> center;
+    double radius;
+};
+
+/**
+ * 多项式在圆盘 D 上取值的外包圆盘（圆盘算术的 Taylor 形式）。
+ *
+ * 在圆心 c 处展开 p(c + h) = sum t_k h^k，则 p(D) 包含于以 t_0 为圆心、sum_{k>=1} |t_k| r^k 为半径的圆盘。
+ * 与矩形区间相比，复数乘法不会因旋转而膨胀，一阶项是精确的。
+ * 半径再按中间量的大小向外扩大，使结果也包含逐像素用 evalPolynomial 计算时带舍入误差的值。
+ */
+inline ComplexDisc evalPolynomialDisc(const std::vector<std::complex<double>>& coeffs, const ComplexDisc& d) {
+    if (coeffs.empty()) return {{0, 0}, 0};
+    const int degree = static_cast<int>(coeffs.size()) - 1;
+    // 综合除法求 Taylor 系数 t_k = p^(k)(c) / k!
+    std::complex<double> t[32];
+    std::vector<std::complex<double>> heap;
+    std::complex<double>* b = t;
+    if (degree >= 32) {
+        heap.resize(degree + 1);
+        b = heap.data();
+    }
+    std::copy(coeffs.begin(), coeffs.end(), b);
+    for (int k = 0; k < degree; ++k)
+        for (int j = degree - 1; j >= k; --j)
+            b[j] += d.center * b[j + 1];
+
+    double radius = 0, rk = 1, scale = 0, zk = 1;
+    const double zMagnitude = std::sqrt(std::norm(d.center)) + d.radius;
+    for (int k = 0; k <= degree; ++k) {
+        if (k > 0) {
+            rk *= d.radius;
+            radius += std::sqrt(std::norm(b[k])) * rk;
+        }
+        scale += std::sqrt(std::norm(coeffs[k])) * zk;
+        zk *= zMagnitude;
+    }
+    return {b[0], radius + 1e-13 * (1 + scale)};
+}
+
+/**
+ * 用圆盘迭代证明区域 disc 内所有起点的逃逸时间相同，返回该迭代次数，无法证明时返回 -1。
+ *
+ * 记第 k 步的外包圆盘为 D_k，逐像素迭代的每一步都满足 z_k ∈ D_k。
+ * 逃逸：D_k 整体在逃逸圆外，且之前各步都整体在圆内，则区域内每一点都恰好在第 k 步逃逸。
+ * 捕获：若 D_j 包含于之前的 D_i（j - i 不超过 16），则 p 次迭代（p = j - i）把 D_i 映入自身，
+ * 之后的轨道都落在 D_i..D_{j-1} 之内，而它们都在逃逸圆内，因此区域内每一点都不会逃逸，返回 maxIterations。
+ * 迭代到 maxIterations 步仍在圆内时同样返回 maxIterations。
+ * 圆盘与逃逸圆相交时立即放弃，failedDiameter 不为空时返回此时圆盘的直径。
+ * 判断时留有 1e-9 的相对余量，与逐像素的浮点比较保持一致。
+ */
+inline int certifyDiscEscapeTime(const std::vector<std::complex<double>>& coeffs, ComplexDisc disc,
+                                 int maxIterations, double escapeRadius, double* failedDiameter = nullptr) {
+    const int maxPeriod = 16;
+    const double inside = escapeRadius * (1 - 1e-9);
+    const double outside = escapeRadius * (1 + 1e-9);
+    ComplexDisc history[maxPeriod]; // 最近 maxPeriod 步的圆盘，环形存放
+    for (int k = 0; k < maxIterations; ++k) {
+        double distance = std::sqrt(std::norm(disc.center));
+        if (distance - disc.radius >= outside) return k;
+        if (distance + disc.radius >= inside) {
+            if (failedDiameter) *failedDiameter = 2 * disc.radius;
+            return -1;
+        }
+        for (int i = 0; i < std::min(k, maxPeriod); ++i)
+            if (std::sqrt(std::norm(disc.center - history[i].center)) + disc.radius <= history[i].radius)
+                return maxIterations;
+        history[k % maxPeriod] = disc;
+        disc = evalPolynomialDisc(coeffs, disc);
+    }
+    // 前 maxIterations 步都在圆内：第 maxIterations 步是否在圆外不影响结果
+    return maxIterations;
+}
+
+/**
+ * 区间认证的逃逸时间渲染，只适用于多项式，有理函数直接按逐像素计算。
+ *
+ * 图像按 tileSize 分块，先用 certifyDiscEscapeTime 对整块做圆盘迭代，证明成功则整块填同一个值；
+ * 否则四分后递归，直到块边长不超过 minTileSize 时逐像素计算。远离集合边界的外部区域和
+ * 吸引域内部可以整块跳过。结果与 generateJuliaMatrix 逐像素一致。
+ * 结果写入 rowOut(y) 返回的行，rowOut 可能在多个线程中对同一行调用，必须每次返回相同的指针；
+ * 返回 nullptr 的行不计算，整个分块行都为 nullptr 时直接跳过。
+ * computedPixels 不为空时返回逐像素计算的像素数。
+ */
+template <typename RowOut>
+void renderJuliaCertifiedRows(
+    double realRangeMin, double realRangeMax, double imagRangeMin, double imagRangeMax,
+    int width, int height,
+    const ParsedFunction& f,
+    int maxIterations,
+    double escapeRadius,
+    const RowOut& rowOut,
+    RenderControl* control = nullptr,
+    long long* computedPixels = nullptr,
+    int tileSize = 32,
+    int minTileSize = 4
+    ) {
+    if (width <= 0 || height <= 0) {
+        if (computedPixels) *computedPixels = 0;
+        return;
+    }
+    const double scaleX = (realRangeMax - realRangeMin) / width;
+    const double scaleY = (imagRangeMax - imagRangeMin) / height;
+    const double escapeRadiusSq = escapeRadius * escapeRadius;
+    const bool certify = f.isPolynomial();
+    auto func = makeFunctionLambda(f);
+    tileSize = std::max(1, tileSize);
+    minTileSize = std::max(1, minTileSize);
+
+    // 包含像素 [x0, x0 + w) x [y0, y0 + h) 起点的圆盘
+    auto pixelDisc = [&](int x0, int y0, int w, int h) {
+        double re0 = x0 * scaleX + realRangeMin, re1 = (x0 + w - 1) * scaleX + realRangeMin;
+        double im0 = y0 * scaleY + imagRangeMin, im1 = (y0 + h - 1) * scaleY + imagRangeMin;
+        std::complex<double> center((re0 + re1) / 2, (im0 + im1) / 2);
+        double radius = std::hypot(re1 - re0, im1 - im0) / 2;
+        return ComplexDisc{center, radius + 1e-13 * (1 + std::abs(center) + radius)};
+    };
+
+    std::atomic<long long> computed{0};
+    std::function<void(int, int, int, int, long long&)> renderTile =
+        [&](int x0, int y0, int w, int h, long long& tileComputed) {
+        if (certify) {
+            double diameter = 0;
+            int value = certifyDiscEscapeTime(f.numerator, pixelDisc(x0, y0, w, h), maxIterations, escapeRadius,
+                                              &diameter);
+            if (value >= 0) {
+                for (int y = y0; y < y0 + h; ++y)
+                    if (int* out = rowOut(y)) std::fill(out + x0, out + x0 + w, value);
+                return;
+            }
+            // 子块的区域大致按边长等比缩小；分到最小块时仍比逃逸半径大得多，说明这里贴近集合边界，
+            // 继续细分只是白白做区间迭代，直接逐像素计算
+            double shrink = static_cast<double>(minTileSize) / std::max(w, h);
+            if ((w > minTileSize || h > minTileSize) && diameter * shrink < escapeRadius) {
+                int w1 = (w + 1) / 2, h1 = (h + 1) / 2;
+                renderTile(x0, y0, w1, h1, tileComputed);
+                if (w > w1) renderTile(x0 + w1, y0, w - w1, h1, tileComputed);
+                if (h > h1) renderTile(x0, y0 + h1, w1, h - h1, tileComputed);
+                if (w > w1 && h > h1) renderTile(x0 + w1, y0 + h1, w - w1, h - h1, tileComputed);
+                return;
+            }
+        }
+        long long pixels = 0;
+        for (int y = y0; y < y0 + h; ++y) {
+            int* out = rowOut(y);
+            if (!out) continue;
+            pixels += w;
+            for (int x = x0; x < x0 + w; ++x) {
+                std::complex<double> z(x * scaleX + realRangeMin, y * scaleY + imagRangeMin);
+                out[x] = juliaEscapeTime(z, func, maxIterations, escapeRadiusSq);
+            }
+        }
+        tileComputed += pixels;
+    };
+
+    // 每个任务处理一行分块
+    const int tileRows = (height + tileSize - 1) / tileSize;
+    if (control) control->begin(tileRows);
+    parallelForRows(tileRows, [&](int tileRow) {
+        if (control && control->isCancelled()) return;
+        const int y0 = tileRow * tileSize;
+        const int h = std::min(tileSize, height - y0);
+        bool skip = true;
+        for (int y = y0; y < y0 + h && skip; ++y)
+            skip = rowOut(y) == nullptr;
+        if (skip) {
+            if (control) control->advance(1);
+            return;
+        }
+        long long rowComputed = 0;
+        for (int x0 = 0; x0 < width; x0 += tileSize)
+            renderTile(x0, y0, std::min(tileSize, width - x0), h, rowComputed);
+        computed += rowComputed;
+        if (control) control->advance(1);
+    });
+
+    if (computedPixels) *computedPixels = computed;
+}
+
+// 区间认证计算 Julia 集并返回二维矩阵，参数见 renderJuliaCertifiedRows
+inline std::vector<std::vector<int>> generateJuliaMatrixCertified(
+    double realRangeMin, double realRangeMax, double imagRangeMin, double imagRangeMax,
+    int width, int height,
+    const ParsedFunction& f,
+    int maxIterations,
+    double escapeRadius = 2.0,
+    long long* computedPixels = nullptr,
+    int tileSize = 32,
+    int minTileSize = 4
+    ) {
+    std::vector<std::vector<int>> matrix(height, std::vector<int>(width));
+    renderJuliaCertifiedRows(realRangeMin, realRangeMax, imagRangeMin, imagRangeMax, width, height,
+                             f, maxIterations, escapeRadius,
+                             [&](int y) { return matrix[y].data(); },
+                             nullptr, computedPixels, tileSize, minTileSize);
+    return matrix;
+}
+
+
+// ==========================================
+// 有理函数的吸引域
+// ==========================================
+
+// 有理函数的一个吸引不动点
+struct RationalAttractor {
+    std::complex<double> point;
+    std::complex<double> multiplier; // R'(point)，模小于 1
+    double captureRadius = 0;        // 轨道进入以 point 为心的这个圆盘后一定收敛到 point（由 R' 在圆盘上的上界证明）
+};
+
+/**
+ * 有理函数 R = P/Q 的吸引不动点，以及无穷远点的性质，由 findRationalAttractors 计算。
+ *
+ * 迭代时显式处理极点：|R(z)| 超过 1e12（包括 Q(z) = 0）时视为到达无穷远点，之后按 R 在无穷远处的行为继续：
+ * 无穷远点吸引时归入无穷远点的吸引域；无穷远点是不吸引的不动点时轨道停在 Julia 集上；
+ * 否则下一步为 R(∞)（分子分母次数相同时为首项系数之比，分母次数更高时为 0）。
+ * 不使用 evalRational 中分母接近 0 时返回的常数。
+ */
+struct RationalAttractors {
+    std::vector<std::complex<double>> numerator;
+    std::vector<std::complex<double>> denominator; // 分母为常数时归一化为 {1}
+    std::vector<RationalAttractor> finite;
+    bool infinityAttracting = false; // 无穷远点是吸引不动点
+    bool infinityFixed = false;      // 无穷远点是不动点（分子次数高于分母）
+    std::complex<double> infinityImage; // infinityFixed 为 false 时 R(∞) 的值
+    double infinityRadius = 0; // 无穷远点吸引时，|z| 不小于它的点一定收敛到无穷远点
+
+    // 无穷远点的吸引域编号，排在有限吸引子之后
+    int infinityIndex() const { return static_cast<int>(finite.size()); }
+};
+
+// 多项式的全部复根（Durand-Kerner 迭代后用牛顿法修正），coeffs[k] 为 z^k 的系数
+std::vector<std::complex<double>> polynomialRoots(const std::vector<std::complex<double>>& coeffs);
+
+// 求 R 的有限不动点（P(z) - z Q(z) 的根）中的吸引不动点，并判断无穷远点是否吸引
+RationalAttractors findRationalAttractors(const ParsedFunction& f);
+
+// 吸引域模式中一个像素的结果
+struct BasinPoint {
+    int basin = -1; // 0..finite.size()-1 为有限吸引子，infinityIndex() 为无穷远点，-1 为未收敛
+    int steps = 0;  // 进入吸引域前的迭代次数
+};
+
+// 从 z 开始迭代，直到进入某个吸引子的捕获圆盘（无穷远点吸引时为 |z| >= escapeRadius）或达到 maxIterations
+inline BasinPoint rationalBasin(const RationalAttractors& a, std::complex<double> z,
+                                int maxIterations, double escapeRadiusSq) {
+    BasinPoint result;
+    bool atInfinity = false;
+    for (int steps = 0; ; ++steps) {
+        result.steps = steps;
+        if (atInfinity) {
+            if (a.infinityAttracting) { result.basin = a.infinityIndex(); return result; }
+            if (a.infinityFixed) return result; // 停在不吸引的不动点上，属于 Julia 集
+        }
+        else {
+            if (a.infinityAttracting && std::norm(z) >= escapeRadiusSq) { result.basin = a.infinityIndex(); return result; }
+            for (size_t i = 0; i < a.finite.size(); ++i) {
+                const double r = a.finite[i].captureRadius;
+                if (std::norm(z - a.finite[i].point) < r * r) { result.basin = static_cast<int>(i); return result; }
+            }
+        }
+        if (steps >= maxIterations) return result;
+
+        if (atInfinity) {
+            z = a.infinityImage;
+            atInfinity = false;
+            continue;
+        }
+        // 不用 std::complex 的除法：它为处理 inf/nan 调用库函数，比迭代本身还慢
+        std::complex<double> p = evalPolynomial(a.numerator, z);
+        if (a.denominator.size() == 1) { // 多项式，分母已归一化为 1
+            z = p;
+            continue;
+        }
+        std::complex<double> q = evalPolynomial(a.denominator, z);
+        double qNorm = std::norm(q);
+        if (std::norm(p) >= 1e24 * qNorm)
+            atInfinity = true;
+        else
+            z = p * std::conj(q) / qNorm;
+    }
+}
+
+/**
+ * 吸引域模式：对每个像素求它收敛到哪个吸引子（basinOut）以及用了多少步（stepOut），
+ * 进入捕获圆盘即停止，收敛到吸引不动点的轨道不必迭代到 maxIterations。
+ * 无穷远点吸引时，逃逸半径取 escapeRadius 与 attractors.infinityRadius 中较大的一个。
+ * 像素坐标、行回调和 control 与 renderJuliaRows 相同；stepOut(y) 返回 nullptr 的行不计算。
+ */
+template <typename StepOut, typename BasinOut>
+void renderRationalBasinRows(
+    double realRangeMin, double realRangeMax, double imagRangeMin, double imagRangeMax,
+    int width, int height,
+    const RationalAttractors& attractors,
+    int maxIterations,
+    double escapeRadius,
+    const StepOut& stepOut,
+    const BasinOut& basinOut,
+    RenderControl* control = nullptr
+    ) {
+    double scaleX = (realRangeMax - realRangeMin) / width;
+    double scaleY = (imagRangeMax - imagRangeMin) / height;
+    // 逃逸半径小于 infinityRadius 时不能保证超出它的轨道收敛到无穷远点
+    const double radius = std::max(escapeRadius, attractors.infinityRadius);
+    const double escapeRadiusSq = radius * radius;
+
+    if (control) control->begin(height);
+    parallelForRows(height, [&](int y) {
+        if (control && control->isCancelled()) return;
+        int* steps = stepOut(y);
+        if (steps) {
+            int* basins = basinOut(y);
+            for (int x = 0; x < width; ++x) {
+                std::complex<double> z(x * scaleX + realRangeMin,
+                                       y * scaleY + imagRangeMin);
+                BasinPoint point = rationalBasin(attractors, z, maxIterations, escapeRadiusSq);
+                steps[x] = point.steps;
+                basins[x] = point.basin;
+            }
+        }
+        if (control) control->advance(1);
+    });
+}
+
+// 吸引域模式的结果矩阵
+struct BasinMatrix {
+    std::vector<std::vector<int>> steps;
+    std::vector<std::vector<int>> basins;
+};
+
+inline BasinMatrix generateRationalBasins(
+    double realRangeMin, double realRangeMax, double imagRangeMin, double imagRangeMax,
+    int width, int height,
+    const RationalAttractors& attractors,
+    int maxIterations,
+    double escapeRadius = 2.0
+    ) {
+    BasinMatrix result;
+    result.steps.resize(height);
+    result.basins.resize(height);
+    renderRationalBasinRows(realRangeMin, realRangeMax, imagRangeMin, imagRangeMax, width, height,
+                            attractors, maxIterations, escapeRadius,
+                            [&](int y) { result.steps[y].assign(width, 0); return result.steps[y].data(); },
+                            [&](int y) { result.basins[y].assign(width, -1); return result.basins[y].data(); });
+    return result;
+}
+
+#endif // JULIAENGINE_H
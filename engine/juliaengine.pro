@@ -0,0 +1,19 @@
+# 单独编译渲染引擎库：qmake engine/juliaengine.pro && make
+# 同时生成静态库和动态库，对外接口见 juliarender.h
+
+TEMPLATE = lib
+TARGET = juliaengine
+CONFIG -= qt
+CONFIG += c++17 static_and_shared build_all
+
+DEFINES += JULIAENGINE_BUILD
+CONFIG(shared, static|shared): DEFINES += JULIAENGINE_SHARED
+
+unix: LIBS += -lpthread
+
+include(engine.pri)
+
+headers.files = juliarender.h
+unix: headers.path = /usr/local/include
+unix: target.path = /usr/local/lib
+INSTALLS += target headers
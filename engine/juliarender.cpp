@@ -0,0 +1,262 @@
+#include "juliarender.h"
+#include "juliaengine.h"
+#include "juliacheckpoint.h"
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+static_assert(std::is_same<int32_t, int>::value, "迭代内核按 int 写入结果，要求 int 为 32 位");
+
+namespace {
+
+// 检查参数和输出缓冲区，错误时抛出 std::invalid_argument
+void validateRender(const JuliaRenderParams& params, const JuliaRenderTarget& target) {
+    const int width = params.width;
+    if (width <= 0 || params.height <= 0)
+        throw std::invalid_argument("图像尺寸必须为正数");
+    if (params.maxIterations <= 0)
+        throw std::invalid_argument("最大迭代次数必须为正数");
+    if (!(params.escapeRadius > 0))
+        throw std::invalid_argument("逃逸半径必须为正数");
+    if (!(params.realMax > params.realMin) || !(params.imagMax > params.imagMin))
+        throw std::invalid_argument("复平面范围无效");
+    if (!target.iterations && !target.iterationRows && !target.smoothIterations && !target.smoothRows && !target.pixels)
+        throw std::invalid_argument("没有提供输出缓冲区");
+    if (target.pixels && !target.colorMap)
+        throw std::invalid_argument("输出像素时必须提供颜色映射");
+    if ((target.iterationStride && target.iterationStride < width) ||
+        (target.smoothStride && target.smoothStride < width) ||
+        (target.pixelStride && target.pixelStride < width))
+        throw std::invalid_argument("行跨度小于图像宽度");
+}
+
+// 输出行的去处：调用方的行指针 / 调用方的连续缓冲区 / 内部临时缓冲区
+// 调用方没有提供时，只在 needed 为 true 时分配临时缓冲区，否则 operator() 返回 nullptr
+template <typename T>
+class OutputRows {
+public:
+    OutputRows(T* const* rows, T* base, std::ptrdiff_t stride, const JuliaRenderParams& params, bool needed)
+        : rows(rows), base(base), stride(stride ? stride : params.width) {
+        if (!rows && !base && needed) {
+            scratch.resize(static_cast<size_t>(params.width) * params.height);
+            this->base = scratch.data();
+            this->stride = params.width;
+        }
+    }
+
+    OutputRows(const OutputRows&) = delete;
+    OutputRows& operator=(const OutputRows&) = delete;
+
+    T* operator()(int y) const { return rows ? rows[y] : base ? base + y * stride : nullptr; }
+
+private:
+    T* const* rows;
+    T* base;
+    std::ptrdiff_t stride;
+    std::vector<T> scratch;
+};
+
+using IterationRows = OutputRows<int>;
+using SmoothRows = OutputRows<float>;
+
+IterationRows iterationRows(const JuliaRenderParams& params, const JuliaRenderTarget& target) {
+    return IterationRows(target.iterationRows, target.iterations, target.iterationStride, params, true);
+}
+
+// 平滑逃逸值的去处，没有请求时 operator() 返回 nullptr
+SmoothRows smoothRows(const JuliaRenderParams& params, const JuliaRenderTarget& target) {
+    const bool requested = params.smooth || target.smoothIterations || target.smoothRows;
+    return SmoothRows(target.smoothRows, target.smoothIterations, target.smoothStride, params, requested);
+}
+
+// 统计迭代次数，按需上色（有平滑值时按平滑值），填写统计信息
+void finishRender(const JuliaRenderParams& params, const JuliaRenderTarget& target,
+                  const IterationRows& rowOut, const SmoothRows& smoothOut,
+                  JuliaRenderStats& result, std::chrono::steady_clock::time_point start, JuliaRenderStats* stats) {
+    const int width = params.width;
+    const int height = params.height;
+    const bool smooth = smoothOut(0) != nullptr;
+
+    // 最小值用于颜色映射
+    int minValue = params.maxIterations;
+    float minSmooth = static_cast<float>(params.maxIterations);
+    for (int y = 0; y < height; ++y) {
+        const int* row = rowOut(y);
+        for (int x = 0; x < width; ++x) {
+            result.iterations += row[x];
+            minValue = std::min(minValue, row[x]);
+        }
+        if (smooth) {
+            const float* smoothRow = smoothOut(y);
+            minSmooth = std::min(minSmooth, *std::min_element(smoothRow, smoothRow + width));
+        }
+    }
+
+    if (target.pixels) {
+        const JuliaColorMap& colorMap = target.colorMap;
+        const float minF = smooth ? minSmooth : static_cast<float>(minValue);
+        const float maxF = static_cast<float>(params.maxIterations);
+        const std::ptrdiff_t pixelStride = target.pixelStride ? target.pixelStride : width;
+        uint32_t* pixels = target.pixels;
+        parallelForRows(height, [&](int y) {
+            uint32_t* line = pixels + y * pixelStride;
+            if (smooth) {
+                const float* row = smoothOut(y);
+                for (int x = 0; x < width; ++x)
+                    line[x] = colorMap(row[x], minF, maxF);
+                return;
+            }
+            const int* row = rowOut(y);
+            for (int x = 0; x < width; ++x)
+                line[x] = colorMap(static_cast<float>(row[x]), minF, maxF);
+        });
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (stats) *stats = result;
+}
+
+} // namespace
+
+bool juliaRender(const JuliaRenderParams& params,
+                 const JuliaRenderTarget& target,
+                 const JuliaProgressCallback& progress,
+                 JuliaRenderStats* stats) {
+    validateRender(params, target);
+    ParsedFunction f = parseRationalFunction(params.function);
+    const int width = params.width;
+    const int height = params.height;
+    IterationRows rowOut = iterationRows(params, target);
+    SmoothRows smoothOut = smoothRows(params, target);
+
+    RenderControl control(progress);
+    JuliaRenderStats result;
+    result.computedPixels = static_cast<long long>(width) * height;
+    auto start = std::chrono::steady_clock::now();
+
+    if (smoothOut(0)) {
+        // 平滑值需要每个像素停止时的 z，只有参考内核能提供
+        renderJuliaSmoothRows(params.realMin, params.realMax, params.imagMin, params.imagMax,
+                              width, height, makeFunctionLambda(f), params.maxIterations, params.escapeRadius,
+                              SmoothEscape(escapeDegree(f), params.maxIterations, params.escapeRadius),
+                              rowOut, smoothOut, &control);
+    }
+    else if (params.useSymmetry) {
+        renderJuliaSymmetricRows(params.realMin, params.realMax, params.imagMin, params.imagMax,
+                                 width, height, f, params.maxIterations, params.escapeRadius,
+                                 rowOut, &control, &result.computedPixels);
+    }
+    else if (params.kernel == CertifiedKernel) {
+        renderJuliaCertifiedRows(params.realMin, params.realMax, params.imagMin, params.imagMax,
+                                 width, height, f, params.maxIterations, params.escapeRadius,
+                                 rowOut, &control, &result.computedPixels);
+    }
+    else if (params.kernel == WavefrontKernel) {
+        renderJuliaWavefrontRows(params.realMin, params.realMax, params.imagMin, params.imagMax,
+                                 width, height, f, params.maxIterations, params.escapeRadius,
+                                 rowOut, &control);
+    }
+    else {
+        renderJuliaRows(params.realMin, params.realMax, params.imagMin, params.imagMax,
+                        width, height, makeFunctionLambda(f), params.maxIterations, params.escapeRadius,
+                        rowOut, &control);
+    }
+    if (control.isCancelled()) return false;
+
+    finishRender(params, target, rowOut, smoothOut, result, start, stats);
+    return true;
+}
+
+bool juliaRenderCheckpointed(const JuliaRenderParams& params,
+                             const JuliaRenderTarget& target,
+                             const JuliaCheckpointSettings& checkpoint,
+                             const JuliaProgressCallback& progress,
+                             JuliaRenderStats* stats) {
+    validateRender(params, target);
+    if (checkpoint.path.empty())
+        throw std::invalid_argument("没有指定检查点文件");
+    if (params.smooth || target.smoothIterations || target.smoothRows)
+        throw std::invalid_argument("检查点渲染不支持平滑逃逸值");
+    ParsedFunction f = parseRationalFunction(params.function);
+    const int width = params.width;
+    const int height = params.height;
+    IterationRows rowOut = iterationRows(params, target);
+    const SmoothRows smoothOut = smoothRows(params, target); // 总是为空
+    const std::function<int*(int)> rows = [&rowOut](int y) { return rowOut(y); };
+
+    RenderCheckpoint file(checkpoint.path, params, checkpoint.bandRows);
+    JuliaRenderStats result;
+    auto start = std::chrono::steady_clock::now();
+
+    // 已完成的条带直接读取
+    std::vector<int> pending;
+    for (int band = 0; band < file.bandCount(); ++band) {
+        if (file.isDone(band)) {
+            file.readBand(band, rows);
+            result.resumedPixels += static_cast<long long>(file.bandLastRow(band) - file.bandFirstRow(band)) * width;
+        }
+        else
+            pending.push_back(band);
+    }
+
+    // 其余条带逐条计算。进度按完成的条带数报告；条带内部也会调用 progress，以便及时取消
+    RenderControl control(progress);
+    control.begin(static_cast<long long>(pending.size()));
+    double fraction = 0;
+    auto lastCommit = std::chrono::steady_clock::now();
+    auto func = makeFunctionLambda(f);
+    for (size_t i = 0; i < pending.size() && !control.isCancelled(); ++i) {
+        const int band = pending[i];
+        const int first = file.bandFirstRow(band), last = file.bandLastRow(band);
+        auto bandOut = [&rowOut, first, last](int y) -> int* {
+            return y >= first && y < last ? rowOut(y) : nullptr;
+        };
+        RenderControl bandControl([&progress, fraction](double) { return !progress || progress(fraction); });
+
+        long long computed = static_cast<long long>(last - first) * width;
+        if (params.kernel == CertifiedKernel)
+            renderJuliaCertifiedRows(params.realMin, params.realMax, params.imagMin, params.imagMax,
+                                     width, height, f, params.maxIterations, params.escapeRadius,
+                                     bandOut, &bandControl, &computed);
+        else
+            renderJuliaRows(params.realMin, params.realMax, params.imagMin, params.imagMax,
+                            width, height, func, params.maxIterations, params.escapeRadius,
+                            bandOut, &bandControl);
+        if (bandControl.isCancelled()) {
+            control.cancel();
+            break;
+        }
+        result.computedPixels += computed;
+
+        file.writeBand(band, rows);
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(now - lastCommit).count() >= checkpoint.intervalSeconds) {
+            file.commit();
+            lastCommit = now;
+        }
+        fraction = static_cast<double>(i + 1) / pending.size();
+        control.advance(1);
+    }
+
+    file.commit();
+    if (control.isCancelled()) return false;
+    if (checkpoint.removeWhenFinished) file.remove();
+
+    finishRender(params, target, rowOut, smoothOut, result, start, stats);
+    return true;
+}
+
+void juliaSetRenderThreads(int threadCount, bool pinThreads) {
+    RenderThreadSettings settings = renderThreadSettings();
+    settings.threadCount = std::max(0, threadCount);
+    settings.pinThreads = pinThreads;
+    setRenderThreadSettings(settings);
+}
+
+int juliaRenderThreadCount() {
+    return renderThreadCount();
+}
+
+const char* juliaEngineVersion() {
+    return "1.0";
+}
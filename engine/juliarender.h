@@ -0,0 +1,145 @@
+#ifndef JULIARENDER_H
+#define JULIARENDER_H
+
+// Julia 集渲染引擎的库接口，不依赖 Qt。
+//
+// 调用方提供输出缓冲区（迭代次数和/或 32 位像素，可带行跨度），
+// 引擎直接把结果写进去，不做中间拷贝。用法：
+//
+//     JuliaRenderParams params;
+//     params.function = "x^2 + (-0.8+0.156i)";
+//     params.width = 1920; params.height = 1080;
+//     std::vector<uint32_t> pixels(1920 * 1080);
+//     JuliaRenderTarget target;
+//     target.pixels = pixels.data();
+//     target.pixelStride = 1920;
+//     target.colorMap = myColorMap;
+//     juliaRender(params, target);
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#if defined(JULIAENGINE_SHARED)
+#  if defined(_WIN32)
+#    if defined(JULIAENGINE_BUILD)
+#      define JULIAENGINE_EXPORT __declspec(dllexport)
+#    else
+#      define JULIAENGINE_EXPORT __declspec(dllimport)
+#    endif
+#  else
+#    define JULIAENGINE_EXPORT __attribute__((visibility("default")))
+#  endif
+#else
+#  define JULIAENGINE_EXPORT
+#endif
+
+// 逃逸时间模式使用的迭代内核，结果相同，只是速度不同
+// CertifiedKernel 用区间迭代整块跳过远离集合边界的区域，只对多项式生效
+enum IterationKernel { ReferenceKernel = 0, WavefrontKernel = 1, CertifiedKernel = 2 };
+
+// 渲染参数
+struct JuliaRenderParams {
+    std::string function;       // 迭代函数，多项式或有理函数，格式同图形界面
+    double realMin = -2.0;
+    double realMax = 2.0;
+    double imagMin = -2.0;
+    double imagMax = 2.0;
+    int width = 0;
+    int height = 0;
+    int maxIterations = 1000;
+    double escapeRadius = 2.0;
+    IterationKernel kernel = ReferenceKernel;
+    bool useSymmetry = false;   // 利用函数的对称性只计算基本区域，优先于 kernel
+    bool smooth = false;        // 计算平滑（分数）逃逸值，像素按平滑值上色；使用参考内核，忽略 kernel 和 useSymmetry
+};
+
+// 颜色映射：把迭代次数映射为 0xAARRGGBB 颜色。
+// minValue 为本次结果中最小的迭代次数（平滑时为最小的平滑值），maxValue 为 maxIterations
+using JuliaColorMap = std::function<uint32_t(float value, float minValue, float maxValue)>;
+
+/**
+ * 输出缓冲区，由调用方分配，渲染期间必须保持有效。
+ *
+ * 迭代次数可以写入连续缓冲区 iterations（相邻两行间隔 iterationStride 个 int），
+ * 或者写入 iterationRows 给出的各行（优先于 iterations）。
+ * 像素写入 pixels（相邻两行间隔 pixelStride 个像素），需要同时提供 colorMap。
+ * 平滑逃逸值写入 smoothIterations 或 smoothRows，提供其中之一即相当于设置 params.smooth。
+ * 迭代次数和像素至少要请求一项；只请求像素时引擎在内部临时保存迭代次数（和平滑值）。
+ * 跨度为 0 时取 width。
+ */
+struct JuliaRenderTarget {
+    int32_t* iterations = nullptr;
+    std::ptrdiff_t iterationStride = 0;
+    int32_t* const* iterationRows = nullptr;
+
+    float* smoothIterations = nullptr;
+    std::ptrdiff_t smoothStride = 0;
+    float* const* smoothRows = nullptr;
+
+    uint32_t* pixels = nullptr;
+    std::ptrdiff_t pixelStride = 0;
+    JuliaColorMap colorMap;
+};
+
+// 渲染统计
+struct JuliaRenderStats {
+    long long computedPixels = 0;   // 逐像素迭代的像素数，使用对称性或区间认证时少于 width * height
+    long long iterations = 0;       // 所有像素的迭代次数之和
+    double seconds = 0;             // 耗时（不含参数解析）
+    long long resumedPixels = 0;    // 从检查点恢复、没有重新计算的像素数
+};
+
+// 进度回调：参数为 [0, 1] 的完成比例，在渲染线程中调用；返回 false 取消渲染
+using JuliaProgressCallback = std::function<bool(double fraction)>;
+
+/**
+ * 按 params 渲染到 target，使用全局渲染线程池（线程数见 juliaSetRenderThreads）。
+ *
+ * 参数或函数格式错误时抛出 std::invalid_argument。
+ * 被 progress 取消时返回 false，此时输出缓冲区中的内容不完整；正常完成返回 true。
+ */
+JULIAENGINE_EXPORT bool juliaRender(const JuliaRenderParams& params,
+                                    const JuliaRenderTarget& target,
+                                    const JuliaProgressCallback& progress = {},
+                                    JuliaRenderStats* stats = nullptr);
+
+// 长时间渲染的检查点设置
+struct JuliaCheckpointSettings {
+    std::string path;               // 检查点文件路径
+    double intervalSeconds = 60;    // 两次落盘（fsync）之间的最短间隔，越大开销越小，中断时丢失的也越多
+    int bandRows = 256;             // 检查点的单位：每条带的行数
+    bool removeWhenFinished = true; // 渲染完成后删除检查点文件
+};
+
+/**
+ * 与 juliaRender 相同，但按行条带渲染，并把完成的条带定期写入检查点文件。
+ *
+ * 检查点文件记录渲染参数、条带完成位图和已完成条带的迭代次数。
+ * 以相同参数再次调用时（例如进程被杀或机器重启后），已完成的条带直接从文件读取，只计算其余条带；
+ * 参数不同则丢弃旧的检查点重新开始。取消时检查点会先落盘，之后仍可续算。
+ * 只有参考内核和区间认证内核支持跳过已完成的行，其余内核和 useSymmetry 按参考内核计算。
+ * 检查点中只保存整数迭代次数，不支持平滑逃逸值。
+ * 参数错误抛出 std::invalid_argument，读写检查点文件失败抛出 std::runtime_error。
+ */
+JULIAENGINE_EXPORT bool juliaRenderCheckpointed(const JuliaRenderParams& params,
+                                                const JuliaRenderTarget& target,
+                                                const JuliaCheckpointSettings& checkpoint,
+                                                const JuliaProgressCallback& progress = {},
+                                                JuliaRenderStats* stats = nullptr);
+
+/**
+ * 设置全局渲染线程池：threadCount 为工作线程数（0 为本进程实际可用的 CPU 数），
+ * pinThreads 为 true 时把每个工作线程绑定到一个 CPU 核心（仅 Linux）。
+ * 设置不变时不重建线程池；正在进行的渲染继续使用原来的线程池，之后的渲染使用新的。
+ */
+JULIAENGINE_EXPORT void juliaSetRenderThreads(int threadCount, bool pinThreads = false);
+
+// 全局渲染线程池当前的工作线程数
+JULIAENGINE_EXPORT int juliaRenderThreadCount();
+
+// 引擎版本号，格式为 "主版本.次版本"
+JULIAENGINE_EXPORT const char* juliaEngineVersion();
+
+#endif // JULIARENDER_H
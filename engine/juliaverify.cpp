@@ -0,0 +1,285 @@
+#include "juliaverify.h"
+#include "juliaengine.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+std::vector<VerifyScene> defaultVerifyScenes() {
+    return {
+        {"quadratic",       "z^2+(-0.7+0.27015i)",     -1.5, 1.5, -1.5, 1.5,     256, 256, 300,  2},
+        {"quadratic-real",  "z^2-1",                   -2, 2, -1.5, 1.5,         240, 180, 500,  2},
+        {"quartic-even",    "z^4+(0.6+0.2i)",          -1.5, 1.5, -1.5, 1.5,     200, 200, 300,  2},
+        {"cubic",           "z^3+(0.4+0.1i)",          -1.5, 1.5, -1.5, 1.5,     200, 200, 300,  2},
+        {"quartic-offset",  "z^4-0.2z+(0.5-0.3i)",     -0.8, 1.6, -1.1, 0.7,     150, 113, 250,  3},
+        {"rational-newton", "(2z^3+1)/(3z^2)",         -2, 2, -2, 2,             160, 160, 100,  4},
+        {"rational",        "(z^2+(0.1+0.2i))/(z^2-0.5)", -2, 2, -2, 2,          128, 128, 200,  10},
+        {"deep",            "z^2+(-0.8+0.156i)",       -0.1, 0.1, -0.1, 0.1,     128, 128, 20000, 2},
+        {"tiny",            "z^2+(-0.7+0.27015i)",     -1.5, 1.5, -1.5, 1.5,     1, 1, 100,    2},
+        {"tiny-strip",      "z^2+(0.285+0.01i)",       -1.5, 1.5, -0.2, 0.3,     3, 2, 100,    2},
+        {"non-square",      "z^2+(0.285+0.01i)",       -1.2, 0.9, -0.9, 0.2,     97, 33, 400,  2},
+    };
+}
+
+std::vector<VerifyPath> engineRenderPaths() {
+    std::vector<VerifyPath> paths;
+
+    // 参数图集：1x1 图集，参数范围退化为原函数的常数项本身
+    VerifyPath atlas;
+    atlas.name = "atlas";
+    atlas.render = [](const VerifyScene& s) {
+        ParsedFunction f = parseRationalFunction(s.function);
+        AtlasLayout layout;
+        layout.columns = layout.rows = 1;
+        layout.cellSize = s.width;
+        layout.coeffIndex = 0;
+        auto c = f.numerator[0];
+        layout.paramRealMin = layout.paramRealMax = c.real();
+        layout.paramImagMin = layout.paramImagMax = c.imag();
+        return generateParameterAtlas(f, layout, s.realMin, s.realMax, s.imagMin, s.imagMax,
+                                      s.maxIterations, s.escapeRadius);
+    };
+    // 图集的缩略图是正方形的，且纵向比例与横向相同
+    atlas.applies = [](const VerifyScene& s) {
+        return s.width == s.height && s.realMax - s.realMin == s.imagMax - s.imagMin;
+    };
+    paths.push_back(atlas);
+
+    // 单线程：线程池只有调用线程本身，检查多线程分行没有改变结果
+    VerifyPath singleThread;
+    singleThread.name = "single-thread";
+    singleThread.render = [](const VerifyScene& s) {
+        const RenderThreadSettings saved = renderThreadSettings();
+        RenderThreadSettings settings = saved;
+        settings.threadCount = 1;
+        setRenderThreadSettings(settings);
+        auto func = getRationalFunctionLambda(s.function).first;
+        auto matrix = generateJuliaMatrix(s.realMin, s.realMax, s.imagMin, s.imagMax,
+                                          s.width, s.height, func, s.maxIterations, s.escapeRadius);
+        setRenderThreadSettings(saved);
+        return matrix;
+    };
+    paths.push_back(singleThread);
+
+    // 波前压缩内核：默认每轮 64 次迭代，另用不整除的小轮次和极小批次检查边界情况
+    for (auto chunk : {std::make_pair(64, 4096), std::make_pair(7, 5)}) {
+        VerifyPath wavefront;
+        wavefront.name = "wavefront-" + std::to_string(chunk.first);
+        wavefront.render = [chunk](const VerifyScene& s) {
+            return generateJuliaMatrixWavefront(s.realMin, s.realMax, s.imagMin, s.imagMax,
+                                                s.width, s.height, parseRationalFunction(s.function),
+                                                s.maxIterations, s.escapeRadius, chunk.first, chunk.second);
+        };
+        paths.push_back(wavefront);
+    }
+
+    // 对称镜像：复制的像素与参考内核在对称像点上的计算结果一致，
+    // 但像点坐标的浮点舍入可能与网格坐标相差最后几位，边界附近允许极少量不一致
+    VerifyPath symmetric;
+    symmetric.name = "symmetric";
+    symmetric.maxMismatchRatio = 0.002;
+    symmetric.render = [](const VerifyScene& s) {
+        return generateJuliaMatrixSymmetric(s.realMin, s.realMax, s.imagMin, s.imagMax,
+                                            s.width, s.height, parseRationalFunction(s.function),
+                                            s.maxIterations, s.escapeRadius);
+    };
+    paths.push_back(symmetric);
+
+    // 库接口：输出到带行跨度的连续缓冲区，跨度大于宽度，检查行偏移是否算对
+    VerifyPath library;
+    library.name = "library-api";
+    library.render = [](const VerifyScene& s) {
+        JuliaRenderParams params;
+        params.function = s.function;
+        params.realMin = s.realMin;
+        params.realMax = s.realMax;
+        params.imagMin = s.imagMin;
+        params.imagMax = s.imagMax;
+        params.width = s.width;
+        params.height = s.height;
+        params.maxIterations = s.maxIterations;
+        params.escapeRadius = s.escapeRadius;
+        const int stride = s.width + 3;
+        std::vector<int32_t> buffer(static_cast<size_t>(stride) * s.height, -1);
+        JuliaRenderTarget target;
+        target.iterations = buffer.data();
+        target.iterationStride = stride;
+        juliaRender(params, target);
+
+        std::vector<std::vector<int>> matrix(s.height);
+        for (int y = 0; y < s.height; ++y)
+            matrix[y].assign(buffer.begin() + y * stride, buffer.begin() + y * stride + s.width);
+        return matrix;
+    };
+    paths.push_back(library);
+
+    // 续算：先用 1/4 的最大迭代次数、一半的逃逸半径计算，再续算到场景参数，结果应与从头计算完全相同
+    VerifyPath resume;
+    resume.name = "resume";
+    resume.render = [](const VerifyScene& s) {
+        auto func = getRationalFunctionLambda(s.function).first;
+        auto state = generateJuliaState(s.realMin, s.realMax, s.imagMin, s.imagMax, s.width, s.height,
+                                        func, std::max(1, s.maxIterations / 4), s.escapeRadius / 2);
+        continueJuliaState(state, func, s.maxIterations, s.escapeRadius);
+        return state.iterations;
+    };
+    paths.push_back(resume);
+
+    // 平滑逃逸值：同一遍迭代中输出的整数迭代次数与参考内核相同
+    VerifyPath smooth;
+    smooth.name = "smooth";
+    smooth.render = [](const VerifyScene& s) {
+        auto func = getRationalFunctionLambda(s.function).first;
+        ParsedFunction f = parseRationalFunction(s.function);
+        std::vector<std::vector<int>> matrix(s.height, std::vector<int>(s.width));
+        std::vector<std::vector<float>> values(s.height, std::vector<float>(s.width));
+        renderJuliaSmoothRows(s.realMin, s.realMax, s.imagMin, s.imagMax, s.width, s.height, func,
+                              s.maxIterations, s.escapeRadius,
+                              SmoothEscape(escapeDegree(f), s.maxIterations, s.escapeRadius),
+                              [&](int y) { return matrix[y].data(); },
+                              [&](int y) { return values[y].data(); });
+        return matrix;
+    };
+    paths.push_back(smooth);
+
+    // 检查点续算：渲染到第 2 条带后取消，再以同一个检查点文件重新渲染到一块新的缓冲区，
+    // 已完成的条带从文件读回，其余条带重新计算，结果必须与参考内核完全一致
+    VerifyPath checkpoint;
+    checkpoint.name = "checkpoint-resume";
+    checkpoint.render = [](const VerifyScene& s) {
+        JuliaRenderParams params;
+        params.function = s.function;
+        params.realMin = s.realMin;
+        params.realMax = s.realMax;
+        params.imagMin = s.imagMin;
+        params.imagMax = s.imagMax;
+        params.width = s.width;
+        params.height = s.height;
+        params.maxIterations = s.maxIterations;
+        params.escapeRadius = s.escapeRadius;
+
+        JuliaCheckpointSettings settings;
+        settings.path = (std::filesystem::temp_directory_path() / ("juliaverify-" + s.name + ".ckpt")).string();
+        settings.intervalSeconds = 0;
+        settings.bandRows = std::max(1, s.height / 5);
+        settings.removeWhenFinished = false;
+        std::remove(settings.path.c_str());
+        const int bands = (s.height + settings.bandRows - 1) / settings.bandRows;
+
+        std::vector<int32_t> first(static_cast<size_t>(s.width) * s.height, -1);
+        JuliaRenderTarget target;
+        target.iterations = first.data();
+        juliaRenderCheckpointed(params, target, settings,
+                                [bands](double fraction) { return fraction * bands < 2; });
+
+        std::vector<int32_t> second(static_cast<size_t>(s.width) * s.height, -1);
+        target.iterations = second.data();
+        settings.removeWhenFinished = true;
+        JuliaRenderStats stats;
+        juliaRenderCheckpointed(params, target, settings, {}, &stats);
+        // 没有从检查点恢复任何像素说明续算没有生效，返回空矩阵使检查失败
+        if (stats.resumedPixels == 0) return std::vector<std::vector<int>>();
+
+        std::vector<std::vector<int>> matrix(s.height);
+        for (int y = 0; y < s.height; ++y)
+            matrix[y].assign(second.begin() + y * s.width, second.begin() + (y + 1) * s.width);
+        return matrix;
+    };
+    paths.push_back(checkpoint);
+
+    // 区间认证：整块填充的值必须与逐像素完全一致；小分块时递归层数少，主要走逐像素
+    for (int tileSize : {32, 8}) {
+        VerifyPath certified;
+        certified.name = "certified-" + std::to_string(tileSize);
+        certified.render = [tileSize](const VerifyScene& s) {
+            return generateJuliaMatrixCertified(s.realMin, s.realMax, s.imagMin, s.imagMax,
+                                                s.width, s.height, parseRationalFunction(s.function),
+                                                s.maxIterations, s.escapeRadius, nullptr, tileSize, 2);
+        };
+        paths.push_back(certified);
+    }
+
+    return paths;
+}
+
+std::vector<VerifyResult> verifyRenderPaths(const std::vector<VerifyScene>& scenes,
+                                            const std::vector<VerifyPath>& paths) {
+    std::vector<VerifyResult> results;
+    for (const auto& scene : scenes) {
+        auto func = getRationalFunctionLambda(scene.function).first;
+        auto reference = generateJuliaMatrix(scene.realMin, scene.realMax, scene.imagMin, scene.imagMax,
+                                             scene.width, scene.height, func,
+                                             scene.maxIterations, scene.escapeRadius);
+        for (const auto& path : paths) {
+            if (!path.applies(scene)) continue;
+
+            VerifyResult result;
+            result.scene = scene.name;
+            result.path = path.name;
+            auto matrix = path.render(scene);
+
+            if (matrix.size() != reference.size() ||
+                (!matrix.empty() && matrix[0].size() != reference[0].size())) {
+                result.sizeMismatch = true;
+                results.push_back(result);
+                continue;
+            }
+            for (size_t y = 0; y < reference.size(); ++y) {
+                for (size_t x = 0; x < reference[y].size(); ++x) {
+                    int delta = std::abs(matrix[y][x] - reference[y][x]);
+                    ++result.pixels;
+                    if (delta != 0) ++result.differing;
+                    if (delta > path.maxIterationDelta) ++result.mismatches;
+                    result.maxDelta = std::max(result.maxDelta, delta);
+                }
+            }
+            result.passed = result.pixels == 0 ||
+                            double(result.mismatches) / result.pixels <= path.maxMismatchRatio;
+            results.push_back(result);
+        }
+    }
+    return results;
+}
+
+namespace {
+
+// 按字符数（而不是 UTF-8 字节数）左对齐到 width
+std::string padRight(const std::string& text, int width) {
+    int characters = 0;
+    for (unsigned char c : text)
+        if ((c & 0xC0) != 0x80) ++characters;
+    return text + std::string(std::max(0, width - characters), ' ');
+}
+
+// 右对齐到 width，内容只有 ASCII
+std::string padLeft(const std::string& text, int width) {
+    return std::string(std::max(0, width - static_cast<int>(text.size())), ' ') + text;
+}
+
+} // namespace
+
+int runVerify(std::ostream& out) {
+    auto results = verifyRenderPaths(defaultVerifyScenes(), engineRenderPaths());
+    int failed = 0;
+    out << padRight("场景", 16) << " " << padRight("路径", 18) << " " << padRight("不一致", 10) << " "
+        << padRight("有差异", 10) << " " << padRight("最大差", 6) << "  结果\n";
+    for (const auto& r : results) {
+        if (!r.passed) ++failed;
+        if (r.sizeMismatch) {
+            out << padRight(r.scene, 16) << " " << padRight(r.path, 18) << " 尺寸不一致  失败\n";
+            continue;
+        }
+        out << padRight(r.scene, 16) << " " << padRight(r.path, 18) << " "
+            << padLeft(std::to_string(r.mismatches) + "/" + std::to_string(r.pixels), 10) << " "
+            << padLeft(std::to_string(r.differing), 10) << " "
+            << padLeft(std::to_string(r.maxDelta), 6) << "  "
+            << (r.passed ? "通过" : "失败") << "\n";
+    }
+    if (failed)
+        out << failed << " 项检查失败\n";
+    else
+        out << "全部通过\n";
+    out.flush();
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,60 @@
+#ifndef JULIAVERIFY_H
+#define JULIAVERIFY_H
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// ==========================================
+// 参考内核对照检查
+// 以最直接的 generateJuliaMatrix 为参考，逐像素比较其它渲染路径的迭代次数，
+// 确保各种优化不会悄悄改变结果。通过 engine/tests/verify.pro（make check）或命令行 JuliaSet --verify 运行。
+// ==========================================
+
+// 一个固定的测试场景
+struct VerifyScene {
+    std::string name;
+    std::string function;
+    double realMin, realMax, imagMin, imagMax;
+    int width, height;
+    int maxIterations;
+    double escapeRadius;
+};
+
+// 一条待检查的渲染路径及其容差
+// 迭代次数之差超过 maxIterationDelta 的像素计为不一致，不一致像素比例不超过 maxMismatchRatio 即为通过
+struct VerifyPath {
+    std::string name;
+    int maxIterationDelta = 0;
+    double maxMismatchRatio = 0.0;
+    std::function<std::vector<std::vector<int>>(const VerifyScene&)> render;
+    // 返回 false 表示该路径不适用于此场景（例如只支持多项式）
+    std::function<bool(const VerifyScene&)> applies = [](const VerifyScene&) { return true; };
+};
+
+struct VerifyResult {
+    std::string scene;
+    std::string path;
+    long long pixels = 0;
+    long long mismatches = 0; // 超出 maxIterationDelta 的像素数
+    long long differing = 0;  // 迭代次数不完全相同的像素数
+    int maxDelta = 0;         // 最大的迭代次数之差
+    bool sizeMismatch = false;
+    bool passed = false;
+};
+
+// 默认场景：多项式、有理函数、深迭代、极小尺寸与非正方形尺寸
+std::vector<VerifyScene> defaultVerifyScenes();
+
+// 引擎中所有的非参考渲染路径
+std::vector<VerifyPath> engineRenderPaths();
+
+// 逐场景、逐路径与参考内核比较
+std::vector<VerifyResult> verifyRenderPaths(const std::vector<VerifyScene>& scenes,
+                                            const std::vector<VerifyPath>& paths);
+
+// 用默认场景检查所有渲染路径，逐项把结果写入 out；全部通过返回 0，否则返回 1，可直接作为进程退出码
+int runVerify(std::ostream& out);
+
+#endif // JULIAVERIFY_H
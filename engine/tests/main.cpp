@@ -0,0 +1,6 @@
+#include "juliaverify.h"
+#include <iostream>
+
+int main() {
+    return runVerify(std::cout);
+}
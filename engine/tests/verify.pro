@@ -0,0 +1,13 @@
+# 渲染引擎自检，不依赖 Qt：qmake engine/tests/verify.pro && make check
+# 以参考内核逐像素检查所有渲染路径，有超出容差的路径时返回非零，make check 随之失败
+
+TEMPLATE = app
+TARGET = juliaverify
+CONFIG -= qt app_bundle
+CONFIG += c++17 console testcase
+
+unix: LIBS += -lpthread
+
+include(../engine.pri)
+
+SOURCES += main.cpp
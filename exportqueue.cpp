@@ -0,0 +1,174 @@
+#include "exportqueue.h"
+#include "colormap.h"
+#include <QImage>
+#include <cstdio>
+
+ExportQueue::ExportQueue(QObject* parent) : QObject(parent) {
+    threads.setMaxThreadCount(1);
+}
+
+ExportQueue::~ExportQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& entry : entries)
+            entry.second->cancelled = true;
+    }
+    threads.waitForDone();
+}
+
+int ExportQueue::enqueue(const JuliaRenderParams& params, int colorMapIndex, ImageFileFormat format,
+                         int compressionLevel, const QString& filename, double checkpointSeconds) {
+    auto entry = std::make_shared<Entry>();
+    entry->job.params = params;
+    entry->job.colorMapIndex = colorMapIndex;
+    entry->job.format = format;
+    entry->job.compressionLevel = compressionLevel;
+    entry->job.filename = filename;
+    entry->job.checkpointSeconds = checkpointSeconds;
+    int id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = nextId++;
+        entry->job.id = id;
+        entries[id] = entry;
+    }
+    threads.start([this, id]() { run(id); });
+    emit jobChanged(id);
+    return id;
+}
+
+void ExportQueue::cancel(int id) {
+    bool wasQueued = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(id);
+        if (it == entries.end()) return;
+        it->second->cancelled = true;
+        // 排队中的任务立即显示为已取消，轮到它时直接跳过
+        if (it->second->job.state == ExportJob::Queued) {
+            it->second->job.state = ExportJob::Cancelled;
+            wasQueued = true;
+        }
+    }
+    if (wasQueued) emit jobChanged(id);
+}
+
+ExportJob ExportQueue::job(int id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(id);
+    return it != entries.end() ? it->second->job : ExportJob();
+}
+
+int ExportQueue::pendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    int count = 0;
+    for (const auto& entry : entries)
+        if (entry.second->job.state == ExportJob::Queued || entry.second->job.state == ExportJob::Running)
+            ++count;
+    return count;
+}
+
+QString ExportQueue::describe(const ExportJob& job) {
+    QString size = QString("%1x%2").arg(job.params.width).arg(job.params.height);
+    switch (job.state) {
+    case ExportJob::Queued:
+        return QString("[排队] %1 %2").arg(size, job.filename);
+    case ExportJob::Running:
+        return QString("[%1%] %2 %3").arg(100.0 * job.progress, 0, 'f', 1).arg(size, job.filename);
+    case ExportJob::Finished:
+        return QString("[完成] %1 %2").arg(size, job.filename);
+    case ExportJob::Failed:
+        return QString("[失败] %1 %2：%3").arg(size, job.filename, job.error);
+    case ExportJob::Cancelled:
+        return QString("[已取消] %1 %2").arg(size, job.filename);
+    }
+    return QString();
+}
+
+void ExportQueue::update(int id, const std::function<void(ExportJob&)>& change) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(id);
+        if (it == entries.end()) return;
+        change(it->second->job);
+    }
+    QMetaObject::invokeMethod(this, [this, id]() { emit jobChanged(id); }, Qt::QueuedConnection);
+}
+
+void ExportQueue::run(int id) {
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entry = entries[id];
+    }
+    if (entry->cancelled) {
+        update(id, [](ExportJob& job) { job.state = ExportJob::Cancelled; });
+        return;
+    }
+
+    // 本线程和渲染线程池都以最低优先级运行；线程数与交互渲染的设置相同
+    lowerCurrentThreadPriority();
+    if (!renderPool) {
+        RenderThreadSettings settings;
+        settings.threadCount = renderThreadSettings().threadCount;
+        settings.lowPriority = true;
+        renderPool = std::make_unique<RenderThreadPool>(settings);
+    }
+    ScopedRenderThreadPool scope(*renderPool);
+
+    update(id, [](ExportJob& job) { job.state = ExportJob::Running; });
+    const ExportJob snapshot = entry->job; // 参数在入队后不再改变
+
+    // 引擎直接写入 QImage 的像素，不经过迭代矩阵和中间图像
+    QImage image(snapshot.params.width, snapshot.params.height, QImage::Format_RGB32);
+    if (image.isNull()) {
+        update(id, [](ExportJob& job) { job.state = ExportJob::Failed; job.error = "内存不足"; });
+        return;
+    }
+    JuliaRenderTarget target;
+    target.pixels = reinterpret_cast<uint32_t*>(image.bits());
+    target.pixelStride = image.bytesPerLine() / static_cast<int>(sizeof(QRgb));
+    target.colorMap = ColorMap::getRangeColorMapFunction(snapshot.colorMapIndex);
+
+    auto progress = [this, id, &entry](double fraction) {
+        if (entry->cancelled) return false;
+        // 进度按 1% 通知界面
+        int percent = static_cast<int>(fraction * 100);
+        if (percent != static_cast<int>(this->job(id).progress * 100))
+            update(id, [fraction](ExportJob& job) { job.progress = fraction; });
+        return true;
+    };
+
+    // 检查点在图像保存成功后才删除，保存失败时重新导出不必再渲染
+    JuliaCheckpointSettings checkpoint;
+    checkpoint.path = (snapshot.filename + ".ckpt").toStdString();
+    checkpoint.intervalSeconds = snapshot.checkpointSeconds;
+    checkpoint.removeWhenFinished = false;
+
+    // 检查点只保存整数迭代次数，平滑着色的导出不写检查点
+    const bool useCheckpoint = snapshot.checkpointSeconds > 0 && !snapshot.params.smooth;
+    bool completed = false;
+    try {
+        if (useCheckpoint)
+            completed = juliaRenderCheckpointed(snapshot.params, target, checkpoint, progress);
+        else
+            completed = juliaRender(snapshot.params, target, progress);
+    } catch (const std::exception& e) {
+        QString message = QString::fromUtf8(e.what());
+        update(id, [message](ExportJob& job) { job.state = ExportJob::Failed; job.error = message; });
+        return;
+    }
+    if (!completed) {
+        update(id, [](ExportJob& job) { job.state = ExportJob::Cancelled; });
+        return;
+    }
+
+    bool saved = ImageExport::save(image, snapshot.filename, snapshot.format, snapshot.compressionLevel);
+    if (saved && useCheckpoint)
+        std::remove(checkpoint.path.c_str());
+    update(id, [saved](ExportJob& job) {
+        job.progress = 1;
+        job.state = saved ? ExportJob::Finished : ExportJob::Failed;
+        if (!saved) job.error = "写入文件失败";
+    });
+}
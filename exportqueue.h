@@ -0,0 +1,82 @@
+#ifndef EXPORTQUEUE_H
+#define EXPORTQUEUE_H
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "juliaengine.h"
+#include "imageexport.h"
+
+// 一个后台导出任务，参数在入队时复制，之后界面上的修改不影响它
+struct ExportJob {
+    enum State { Queued, Running, Finished, Failed, Cancelled };
+
+    int id = 0;
+    JuliaRenderParams params;
+    int colorMapIndex = 0;
+    ImageFileFormat format = ImageFileFormat::PNG;
+    int compressionLevel = 6;
+    QString filename;
+    double checkpointSeconds = 60; // 检查点落盘间隔，0 表示不使用检查点
+
+    State state = Queued;
+    double progress = 0;   // [0, 1]
+    QString error;         // 失败原因
+};
+
+/**
+ * 后台导出队列：按入队顺序逐个渲染并保存当前视图的高分辨率版本。
+ *
+ * 导出使用单独的渲染线程池，工作线程以最低调度优先级运行，只占用交互渲染剩下的 CPU，
+ * 因此导出期间仍可流畅地浏览。每个任务可随时取消，进度通过 jobChanged 通知（在界面线程中发出）。
+ *
+ * 渲染进度定期写入输出文件旁的检查点文件（文件名加 .ckpt），任务被取消或程序退出后，
+ * 以相同参数和文件名重新入队时从检查点继续；保存成功后删除检查点文件。
+ */
+class ExportQueue : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ExportQueue(QObject* parent = nullptr);
+    // 取消所有任务并等待正在进行的任务结束
+    ~ExportQueue() override;
+
+    // 入队，返回任务编号
+    int enqueue(const JuliaRenderParams& params, int colorMapIndex, ImageFileFormat format,
+                int compressionLevel, const QString& filename, double checkpointSeconds = 60);
+    // 取消任务：排队中的任务不再执行，正在渲染的任务在下一次进度回调时停止
+    void cancel(int id);
+    // 任务当前状态的副本，id 不存在时返回 id 为 0 的任务
+    ExportJob job(int id) const;
+    // 未结束（排队中或进行中）的任务数
+    int pendingCount() const;
+
+    // 供界面显示的一行说明
+    static QString describe(const ExportJob& job);
+
+signals:
+    void jobChanged(int id);
+
+private:
+    struct Entry {
+        ExportJob job;
+        std::atomic<bool> cancelled{false};
+    };
+
+    void run(int id);
+    // 在任意线程中更新任务状态并通知界面
+    void update(int id, const std::function<void(ExportJob&)>& change);
+
+    mutable std::mutex mutex;
+    std::map<int, std::shared_ptr<Entry>> entries;
+    int nextId = 1;
+
+    QThreadPool threads;                         // 只有一个线程，任务按顺序执行
+    std::unique_ptr<RenderThreadPool> renderPool; // 低优先级渲染线程池，在第一个任务开始时创建
+};
+
+#endif // EXPORTQUEUE_H
@@ -0,0 +1,136 @@
+#include "imageexport.h"
+#include <QFile>
+#include <QByteArray>
+#include <algorithm>
+
+QStringList ImageExport::formatNames = {
+    "PNG",
+    "PPM（无压缩）",
+    "BMP（无压缩）",
+    "QOI（快速无损）",
+    "RAW RGBA"
+};
+
+QString ImageExport::suffix(ImageFileFormat format) {
+    switch (format) {
+    case ImageFileFormat::PPM:     return ".ppm";
+    case ImageFileFormat::BMP:     return ".bmp";
+    case ImageFileFormat::QOI:     return ".qoi";
+    case ImageFileFormat::RawRGBA: return ".rgba";
+    case ImageFileFormat::PNG:
+    default:                       return ".png";
+    }
+}
+
+bool ImageExport::save(const QImage& image, const QString& path, ImageFileFormat format, int compressionLevel) {
+    switch (format) {
+    case ImageFileFormat::PPM:
+        return image.save(path, "PPM");
+    case ImageFileFormat::BMP:
+        return image.save(path, "BMP");
+    case ImageFileFormat::QOI:
+        return writeQoi(image, path);
+    case ImageFileFormat::RawRGBA:
+        return writeRawRgba(image, path);
+    case ImageFileFormat::PNG:
+    default: {
+        // Qt 的 PNG quality: 0 为最高压缩，100 为不压缩
+        int level = std::clamp(compressionLevel, 0, 9);
+        return image.save(path, "PNG", 100 - level * 100 / 9);
+    }
+    }
+}
+
+// 按 https://qoiformat.org/qoi-specification.pdf 编码
+bool ImageExport::writeQoi(const QImage& image, const QString& path) {
+    QImage rgba = image.convertToFormat(QImage::Format_RGBA8888);
+    const int width = rgba.width();
+    const int height = rgba.height();
+
+    QByteArray out;
+    out.reserve(14 + width * height * 2 + 8);
+
+    auto put32 = [&out](quint32 v) {
+        out.append(char(v >> 24)); out.append(char(v >> 16)); out.append(char(v >> 8)); out.append(char(v));
+    };
+    out.append("qoif", 4);
+    put32(width);
+    put32(height);
+    out.append(char(4)); // RGBA
+    out.append(char(0)); // sRGB
+
+    struct Px { uchar r, g, b, a; };
+    Px index[64] = {};
+    Px prev = {0, 0, 0, 255};
+    int run = 0;
+
+    for (int y = 0; y < height; ++y) {
+        const uchar* line = rgba.constScanLine(y);
+        for (int x = 0; x < width; ++x) {
+            Px px = {line[4 * x], line[4 * x + 1], line[4 * x + 2], line[4 * x + 3]};
+            bool last = (y == height - 1 && x == width - 1);
+
+            if (px.r == prev.r && px.g == prev.g && px.b == prev.b && px.a == prev.a) {
+                ++run;
+                if (run == 62 || last) {
+                    out.append(char(0xc0 | (run - 1))); // QOI_OP_RUN
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0) {
+                out.append(char(0xc0 | (run - 1)));
+                run = 0;
+            }
+
+            int hash = (px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64;
+            const Px& cached = index[hash];
+            if (cached.r == px.r && cached.g == px.g && cached.b == px.b && cached.a == px.a) {
+                out.append(char(hash)); // QOI_OP_INDEX
+            }
+            else {
+                index[hash] = px;
+                if (px.a == prev.a) {
+                    signed char dr = px.r - prev.r;
+                    signed char dg = px.g - prev.g;
+                    signed char db = px.b - prev.b;
+                    signed char drg = dr - dg;
+                    signed char dbg = db - dg;
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                        out.append(char(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2))); // QOI_OP_DIFF
+                    }
+                    else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+                        out.append(char(0x80 | (dg + 32)));         // QOI_OP_LUMA
+                        out.append(char((drg + 8) << 4 | (dbg + 8)));
+                    }
+                    else {
+                        out.append(char(0xfe)); // QOI_OP_RGB
+                        out.append(char(px.r)); out.append(char(px.g)); out.append(char(px.b));
+                    }
+                }
+                else {
+                    out.append(char(0xff)); // QOI_OP_RGBA
+                    out.append(char(px.r)); out.append(char(px.g)); out.append(char(px.b)); out.append(char(px.a));
+                }
+            }
+            prev = px;
+        }
+    }
+    out.append("\0\0\0\0\0\0\0\1", 8);
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    return file.write(out) == out.size();
+}
+
+bool ImageExport::writeRawRgba(const QImage& image, const QString& path) {
+    QImage rgba = image.convertToFormat(QImage::Format_RGBA8888);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    const qint64 lineBytes = qint64(rgba.width()) * 4;
+    for (int y = 0; y < rgba.height(); ++y) {
+        if (file.write(reinterpret_cast<const char*>(rgba.constScanLine(y)), lineBytes) != lineBytes)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef IMAGEEXPORT_H
+#define IMAGEEXPORT_H
+
+#include <QImage>
+#include <QString>
+#include <QStringList>
+
+// 图像保存格式
+// PNG 可选压缩等级；其余格式不压缩或只做极轻量的压缩，用于需要快速落盘的流水线
+enum class ImageFileFormat {
+    PNG = 0,
+    PPM,     // 二进制 PPM (P6)，无压缩
+    BMP,     // 无压缩 BMP
+    QOI,     // Quite OK Image，无损且编码很快
+    RawRGBA  // 无文件头的 RGBA8888 像素，宽高写在文件名中
+};
+
+class ImageExport {
+public:
+    // 下拉框中显示的格式名称，与 ImageFileFormat 一一对应
+    static QStringList formatNames;
+
+    // 文件扩展名（含点号）
+    static QString suffix(ImageFileFormat format);
+
+    // 保存图像，compressionLevel 为 0-9，只对 PNG 生效
+    // 可在任意线程中调用，返回是否成功
+    static bool save(const QImage& image, const QString& path, ImageFileFormat format, int compressionLevel = 6);
+
+private:
+    static bool writeQoi(const QImage& image, const QString& path);
+    static bool writeRawRgba(const QImage& image, const QString& path);
+};
+
+#endif // IMAGEEXPORT_H
@@ -0,0 +1,289 @@
+#include "iterationfile.h"
+#include "colormap.h"
+#include "juliadraw.h"
+#include <QByteArray>
+#include <QtEndian>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const char magic[4] = {'J', 'I', 'T', 'S'};
+const quint32 formatVersion = 2; // 版本 2 在文件头中加入 basinCount
+
+enum HeaderFlags : quint32 {
+    FlagCompressed = 1u << 0
+};
+
+// 文件头的写入/读取辅助函数
+void putU32(QByteArray& out, quint32 v) {
+    v = qToLittleEndian(v);
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+void putI32(QByteArray& out, qint32 v) { putU32(out, static_cast<quint32>(v)); }
+void putU64(QByteArray& out, quint64 v) {
+    v = qToLittleEndian(v);
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+void putF64(QByteArray& out, double v) {
+    quint64 bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    putU64(out, bits);
+}
+
+struct Reader {
+    const uchar* data;
+    qint64 size;
+    qint64 pos = 0;
+    bool ok = true;
+
+    const uchar* take(qint64 n) {
+        if (!ok || pos + n > size) { ok = false; return nullptr; }
+        const uchar* p = data + pos;
+        pos += n;
+        return p;
+    }
+    quint32 u32() { auto p = take(4); return p ? qFromLittleEndian<quint32>(p) : 0; }
+    qint32 i32() { return static_cast<qint32>(u32()); }
+    quint64 u64() { auto p = take(8); return p ? qFromLittleEndian<quint64>(p) : 0; }
+    double f64() { quint64 bits = u64(); double v; std::memcpy(&v, &bits, sizeof(v)); return v; }
+};
+
+} // namespace
+
+bool IterationFile::write(const QString& path,
+                          const std::vector<std::vector<int>>& matrix,
+                          const IterationFileParams& params,
+                          const std::vector<std::vector<int>>& basins,
+                          bool compressTiles,
+                          int tileSize) {
+    const int width = params.width;
+    const int height = params.height;
+    auto sizeMatches = [&](const std::vector<std::vector<int>>& plane) {
+        return static_cast<int>(plane.size()) == height && (height == 0 || static_cast<int>(plane[0].size()) == width);
+    };
+    if (!sizeMatches(matrix) || (params.basinCount > 0 && !sizeMatches(basins)))
+        return false;
+    std::vector<const std::vector<std::vector<int>>*> planes = {&matrix};
+    if (params.basinCount > 0) planes.push_back(&basins);
+    tileSize = std::max(16, tileSize);
+    const int tilesX = (width + tileSize - 1) / tileSize;
+    const int tilesY = (height + tileSize - 1) / tileSize;
+
+    QByteArray head;
+    head.append(magic, 4);
+    putU32(head, formatVersion);
+    putU32(head, compressTiles ? FlagCompressed : 0);
+    putU32(head, width);
+    putU32(head, height);
+    putU32(head, tileSize);
+    putI32(head, params.maxIterations);
+    putI32(head, params.renderMode);
+    putI32(head, params.atlasColumns);
+    putI32(head, params.atlasCoeffIndex);
+    putI32(head, params.minValue);
+    putI32(head, params.maxValue);
+    putF64(head, params.realMin);
+    putF64(head, params.realMax);
+    putF64(head, params.imagMin);
+    putF64(head, params.imagMax);
+    putF64(head, params.escapeRadius);
+    putI32(head, params.basinCount);
+    putU32(head, static_cast<quint32>(params.function.size()));
+    head.append(params.function.data(), static_cast<int>(params.function.size()));
+
+    // 分块索引放在文件头之后，数据区从索引之后开始
+    const qint64 indexOffset = head.size();
+    quint64 dataOffset = indexOffset + qint64(tilesX) * tilesY * planes.size() * 16;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(head);
+
+    QByteArray index;
+    std::vector<QByteArray> tiles;
+    tiles.reserve(tilesX * tilesY * planes.size());
+    for (const auto* plane : planes) {
+        for (int ty = 0; ty < tilesY; ++ty) {
+            for (int tx = 0; tx < tilesX; ++tx) {
+                const int x0 = tx * tileSize, y0 = ty * tileSize;
+                const int w = std::min(tileSize, width - x0), h = std::min(tileSize, height - y0);
+                QByteArray raw(w * h * 4, Qt::Uninitialized);
+                qint32* dst = reinterpret_cast<qint32*>(raw.data());
+                for (int y = 0; y < h; ++y)
+                    for (int x = 0; x < w; ++x)
+                        dst[y * w + x] = qToLittleEndian<qint32>((*plane)[y0 + y][x0 + x]);
+                tiles.push_back(compressTiles ? qCompress(raw, 1) : raw);
+                putU64(index, dataOffset);
+                putU64(index, tiles.back().size());
+                dataOffset += tiles.back().size();
+            }
+        }
+    }
+    file.write(index);
+    for (const auto& tile : tiles)
+        file.write(tile);
+    return file.commit();
+}
+
+bool IterationFile::open(const QString& path) {
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    mappedSize = file.size();
+    mapped = file.map(0, mappedSize);
+    if (!mapped) {
+        error = "无法映射文件";
+        file.close();
+        return false;
+    }
+
+    Reader r{mapped, mappedSize};
+    const uchar* m = r.take(4);
+    if (!m || std::memcmp(m, magic, 4) != 0) {
+        error = "不是迭代数据文件";
+        close();
+        return false;
+    }
+    const quint32 version = r.u32();
+    if (version < 1 || version > formatVersion) {
+        error = "不支持的文件版本";
+        close();
+        return false;
+    }
+    compressed = r.u32() & FlagCompressed;
+    header.width = r.u32();
+    header.height = r.u32();
+    tileSize = r.u32();
+    header.maxIterations = r.i32();
+    header.renderMode = r.i32();
+    header.atlasColumns = r.i32();
+    header.atlasCoeffIndex = r.i32();
+    header.minValue = r.i32();
+    header.maxValue = r.i32();
+    header.realMin = r.f64();
+    header.realMax = r.f64();
+    header.imagMin = r.f64();
+    header.imagMax = r.f64();
+    header.escapeRadius = r.f64();
+    header.basinCount = version >= 2 ? r.i32() : 0;
+    quint32 funcLen = r.u32();
+    const uchar* funcData = r.take(funcLen);
+    if (!r.ok || tileSize <= 0 || header.basinCount < 0) {
+        error = "文件头已损坏";
+        close();
+        return false;
+    }
+    header.function.assign(reinterpret_cast<const char*>(funcData), funcLen);
+
+    tilesX = (header.width + tileSize - 1) / tileSize;
+    tilesY = (header.height + tileSize - 1) / tileSize;
+    indexOffset = r.pos;
+    const int planeCount = header.basinCount > 0 ? 2 : 1;
+    if (indexOffset + qint64(tilesX) * tilesY * planeCount * 16 > mappedSize) {
+        error = "分块索引已损坏";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void IterationFile::close() {
+    if (mapped) file.unmap(mapped);
+    mapped = nullptr;
+    mappedSize = 0;
+    if (file.isOpen()) file.close();
+}
+
+std::vector<int> IterationFile::readTile(Plane plane, int tx, int ty, int& tileW, int& tileH) const {
+    tileW = std::min(tileSize, header.width - tx * tileSize);
+    tileH = std::min(tileSize, header.height - ty * tileSize);
+    std::vector<int> tile(static_cast<size_t>(tileW) * tileH, 0);
+    if (!hasPlane(plane)) return tile;
+
+    const uchar* entry = mapped + indexOffset + ((qint64(plane) * tilesY + ty) * tilesX + tx) * 16;
+    quint64 offset = qFromLittleEndian<quint64>(entry);
+    quint64 size = qFromLittleEndian<quint64>(entry + 8);
+    if (offset + size > quint64(mappedSize)) return tile;
+
+    const uchar* src = mapped + offset;
+    QByteArray raw;
+    if (compressed) {
+        raw = qUncompress(src, static_cast<int>(size));
+        src = reinterpret_cast<const uchar*>(raw.constData());
+        size = raw.size();
+    }
+    if (size < tile.size() * 4) return tile;
+    for (size_t i = 0; i < tile.size(); ++i)
+        tile[i] = qFromLittleEndian<qint32>(src + 4 * i);
+    return tile;
+}
+
+std::vector<std::vector<int>> IterationFile::readRegion(int x, int y, int w, int h, Plane plane) const {
+    x = std::clamp(x, 0, header.width);
+    y = std::clamp(y, 0, header.height);
+    w = std::clamp(w, 0, header.width - x);
+    h = std::clamp(h, 0, header.height - y);
+    std::vector<std::vector<int>> region(h, std::vector<int>(w));
+    if (!mapped || w == 0 || h == 0) return region;
+
+    for (int ty = y / tileSize; ty <= (y + h - 1) / tileSize; ++ty) {
+        for (int tx = x / tileSize; tx <= (x + w - 1) / tileSize; ++tx) {
+            int tileW, tileH;
+            std::vector<int> tile = readTile(plane, tx, ty, tileW, tileH);
+            const int x0 = tx * tileSize, y0 = ty * tileSize;
+            for (int j = std::max(y, y0); j < std::min(y + h, y0 + tileH); ++j)
+                for (int i = std::max(x, x0); i < std::min(x + w, x0 + tileW); ++i)
+                    region[j - y][i - x] = tile[(j - y0) * tileW + (i - x0)];
+        }
+    }
+    return region;
+}
+
+QImage IterationFile::colorize(const std::function<QRgb(float)>& getColor) const {
+    QImage image(header.width, header.height, QImage::Format_RGB32);
+    if (!mapped) return image;
+
+    // 吸引域文件的亮度范围取已收敛像素中最大的步数，先逐块统计一遍
+    std::function<QRgb(int, int)> basinColor;
+    if (header.basinCount > 0) {
+        int maxSteps = 1;
+        for (int ty = 0; ty < tilesY; ++ty) {
+            for (int tx = 0; tx < tilesX; ++tx) {
+                int tileW, tileH;
+                std::vector<int> steps = readTile(IterationPlane, tx, ty, tileW, tileH);
+                std::vector<int> basins = readTile(BasinPlane, tx, ty, tileW, tileH);
+                for (size_t i = 0; i < steps.size(); ++i)
+                    if (basins[i] >= 0) maxSteps = std::max(maxSteps, steps[i]);
+            }
+        }
+        basinColor = basinColorFunction(header.basinCount, maxSteps);
+    }
+
+    for (int ty = 0; ty < tilesY; ++ty) {
+        for (int tx = 0; tx < tilesX; ++tx) {
+            int tileW, tileH;
+            std::vector<int> tile = readTile(IterationPlane, tx, ty, tileW, tileH);
+            std::vector<int> basins;
+            if (basinColor) basins = readTile(BasinPlane, tx, ty, tileW, tileH);
+            for (int y = 0; y < tileH; ++y) {
+                QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(ty * tileSize + y)) + tx * tileSize;
+                for (int x = 0; x < tileW; ++x) {
+                    const int i = y * tileW + x;
+                    line[x] = basinColor ? basinColor(tile[i], basins[i]) : getColor(tile[i]);
+                }
+            }
+        }
+    }
+    return image;
+}
+
+std::function<QRgb(float)> IterationFile::colorMapFunction(int colorMapIndex) const {
+    if (header.renderMode == Buddhabrot || header.renderMode == AntiBuddhabrot)
+        return ColorMap::getDensityColorMapFunction(colorMapIndex, header.maxValue);
+    return ColorMap::getColorMapFunction(colorMapIndex, header.minValue, header.maxIterations);
+}
@@ -0,0 +1,97 @@
+#ifndef ITERATIONFILE_H
+#define ITERATIONFILE_H
+
+#include <QFile>
+#include <QImage>
+#include <QString>
+#include <QRgb>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 迭代数据文件中记录的渲染参数，足以在不重新计算的情况下重新上色
+struct IterationFileParams {
+    std::string function;  // 函数的字符串表示
+    double realMin = 0, realMax = 0, imagMin = 0, imagMax = 0;
+    int width = 0;
+    int height = 0;
+    int maxIterations = 0;
+    double escapeRadius = 2;
+    int renderMode = 0;    // RenderMode
+    int atlasColumns = 0;  // 参数图集模式下的网格数
+    int atlasCoeffIndex = 0;
+    int minValue = 0;      // 矩阵中的最小/最大值，用于确定颜色映射范围
+    int maxValue = 0;
+    int basinCount = 0;    // 吸引域模式下的吸引子个数；大于 0 时文件中还保存了每个像素所属的吸引子
+};
+
+/**
+ * 迭代数据文件 (.jit)：保存原始迭代矩阵和全部渲染参数，用于换颜色映射时免去重新计算。
+ *
+ * 文件布局（小端序）：
+ *   文件头     magic "JITS"、版本号、参数、函数字符串
+ *   分块索引   每个分块一项 (偏移, 字节数)
+ *   分块数据   tileSize x tileSize 的 int32 迭代次数（边缘分块按实际尺寸），可选 zlib 压缩
+ *
+ * basinCount 大于 0 时有第二个平面（吸引子编号），它的分块索引和数据接在迭代次数平面之后，布局相同。
+ * 版本 2 在文件头中加入了 basinCount，仍可读取版本 1 的文件。
+ *
+ * 读取时整个文件通过 QFile::map 映射到内存，按区域只解码需要的分块，
+ * 因此很大的文件也可以逐块上色而无需一次读入整个矩阵。
+ */
+class IterationFile {
+public:
+    // 文件中的数据平面
+    enum Plane { IterationPlane = 0, BasinPlane = 1 };
+
+    // 写入迭代矩阵，可在任意线程中调用。params.basinCount 大于 0 时 basins 为同样尺寸的吸引子编号
+    static bool write(const QString& path,
+                      const std::vector<std::vector<int>>& matrix,
+                      const IterationFileParams& params,
+                      const std::vector<std::vector<int>>& basins = {},
+                      bool compressTiles = true,
+                      int tileSize = 256);
+
+    IterationFile() = default;
+    IterationFile(const IterationFile&) = delete;
+    IterationFile& operator=(const IterationFile&) = delete;
+    ~IterationFile() { close(); }
+
+    // 映射文件并解析文件头，格式不正确时返回 false，errorString() 给出原因
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const { return mapped != nullptr; }
+    const QString& errorString() const { return error; }
+
+    const IterationFileParams& params() const { return header; }
+
+    // 读取 [x, x+w) x [y, y+h) 区域的迭代次数（或吸引子编号，文件中没有该平面时全为 0）
+    std::vector<std::vector<int>> readRegion(int x, int y, int w, int h, Plane plane = IterationPlane) const;
+    std::vector<std::vector<int>> readAll(Plane plane = IterationPlane) const {
+        return readRegion(0, 0, header.width, header.height, plane);
+    }
+    bool hasPlane(Plane plane) const { return plane == IterationPlane || header.basinCount > 0; }
+
+    // 按分块逐个解码并上色，不需要完整的迭代矩阵；吸引域文件按吸引子上色，忽略 getColor
+    QImage colorize(const std::function<QRgb(float)>& getColor) const;
+
+    // 与 JuliaWidget 一致的颜色映射：逃逸时间按 [minValue, maxIterations]，轨道密度取平方根
+    std::function<QRgb(float)> colorMapFunction(int colorMapIndex) const;
+
+private:
+    // 解码一个分块，返回 tileW x tileH 的行优先数据
+    std::vector<int> readTile(Plane plane, int tx, int ty, int& tileW, int& tileH) const;
+
+    QFile file;
+    uchar* mapped = nullptr;
+    qint64 mappedSize = 0;
+    QString error;
+
+    IterationFileParams header;
+    int tileSize = 0;
+    bool compressed = false;
+    int tilesX = 0, tilesY = 0;
+    qint64 indexOffset = 0;
+};
+
+#endif // ITERATIONFILE_H
@@ -1,47 +1,9 @@
 #include "juliadraw.h"
 #include <QColor>
-#include <thread>
+#include <algorithm>
+#include <cmath>
 #include <functional>
-#include <math.h>
 #include <vector>
-#include <complex>
-
-
-
-// 计算 Mandelbrot 集并返回一个二维矩阵，表示迭代了多少次
-std::vector<std::vector<int>> generateMandelbrotMatrix(int width, int height, const int n, const std::complex<double>& constant, int maxIterations) {
-    std::vector<std::vector<int>> matrix(height, std::vector<int>(width));
-    double scaleX = 3.0 / width;
-    double scaleY = 3.0 / height;
-
-    auto computeRow = [&](int startY, int step) {
-        for (int y = startY; y < height; y += step) {
-            for (int x = 0; x < width; ++x) {
-                std::complex<double> c((x - width / 2) * scaleX, (y - height / 2) * scaleY);
-                std::complex<double> z(0, 0);
-                int iterations = 0;
-                while (std::abs(z) < 2.0 && iterations < maxIterations) {
-                    z = pow(z, n) + c;
-                    ++iterations;
-                }
-                matrix[y][x] = iterations;
-            }
-        }
-    };
-
-    // 使用多个线程来并行计算
-    const int threadCount = std::thread::hardware_concurrency();
-    std::vector<std::thread> threads;
-    for (int i = 0; i < threadCount; ++i) {
-        threads.emplace_back(computeRow, i, threadCount);
-    }
-    for (auto& thread : threads) {
-        thread.join();
-    }
-
-    return matrix;
-}
-
 
 // 将 Julia 集矩阵返回为为 QImage 图片
 QImage getJuliaImage(const std::vector<std::vector<int>>& matrix, std::function<QRgb(float)> getColor) {
@@ -57,5 +19,47 @@ QImage getJuliaImage(const std::vector<std::vector<int>>& matrix, std::function<
     return image;
 }
 
+QImage getJuliaImage(const std::vector<std::vector<float>>& matrix, std::function<QRgb(float)> getColor) {
+    int width = matrix[0].size();
+    int height = matrix.size();
+    QImage image(width, height, QImage::Format_RGB32);
+    for (int y = 0; y < height; ++y) {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < width; ++x)
+            line[x] = getColor(matrix[y][x]);
+    }
+    return image;
+}
+
+std::function<QRgb(int, int)> basinColorFunction(int basinCount, int maxSteps) {
+    const double logMax = std::log(1.0 + std::max(1, maxSteps));
+    basinCount = std::max(1, basinCount);
+    return [basinCount, logMax](int steps, int basin) -> QRgb {
+        if (basin < 0) return qRgb(0, 0, 0);
+        int hue = 360 * (basin % basinCount) / basinCount;
+        double shade = std::min(1.0, std::log(1.0 + std::max(0, steps)) / logMax);
+        int value = static_cast<int>(255 * (1 - 0.8 * shade));
+        return QColor::fromHsv(hue, 200, value).rgb();
+    };
+}
+
+QImage getBasinImage(const std::vector<std::vector<int>>& steps, const std::vector<std::vector<int>>& basins, int basinCount) {
+    int width = steps[0].size();
+    int height = steps.size();
+    int maxSteps = 1;
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+            if (basins[y][x] >= 0) maxSteps = std::max(maxSteps, steps[y][x]);
+    auto getColor = basinColorFunction(basinCount, maxSteps);
+
+    QImage image(width, height, QImage::Format_RGB32);
+    for (int y = 0; y < height; ++y) {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < width; ++x)
+            line[x] = getColor(steps[y][x], basins[y][x]);
+    }
+    return image;
+}
+
 // 定义复数类型
 //using Complex = std::complex<double>;
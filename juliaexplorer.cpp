@@ -0,0 +1,212 @@
+#include "juliaexplorer.h"
+#include "colormap.h"
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// 把迭代次数上色为 QImage，最小值取自结果本身
+QImage colorIterations(const std::vector<int>& iterations, int width, int height, int maxIterations,
+                       const std::function<QRgb(float, float, float)>& colorMap) {
+    int minValue = maxIterations;
+    for (int value : iterations)
+        minValue = std::min(minValue, value);
+    QImage image(width, height, QImage::Format_RGB32);
+    for (int y = 0; y < height; ++y) {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        const int* row = iterations.data() + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; ++x)
+            line[x] = colorMap(static_cast<float>(row[x]), static_cast<float>(minValue),
+                               static_cast<float>(maxIterations));
+    }
+    return image;
+}
+
+} // namespace
+
+JuliaExplorer::JuliaExplorer(QWidget* parent) : QWidget(parent) {
+    planeLabel = new QLabel;
+    planeLabel->setFixedSize(panelSize, panelSize);
+    planeLabel->setAlignment(Qt::AlignLeft | Qt::AlignTop);
+    planeLabel->setMouseTracking(true);
+    planeLabel->setCursor(Qt::CrossCursor);
+    planeLabel->installEventFilter(this);
+
+    previewLabel = new QLabel("将光标移到左侧参数平面上");
+    previewLabel->setFixedSize(panelSize, panelSize);
+    previewLabel->setAlignment(Qt::AlignCenter);
+
+    infoLabel = new QLabel("悬停预览 z^2+c 的 Julia 集，停下或点击后生成全分辨率图像");
+
+    QHBoxLayout* panels = new QHBoxLayout;
+    panels->addWidget(planeLabel);
+    panels->addWidget(previewLabel);
+    panels->addStretch();
+    QVBoxLayout* layout = new QVBoxLayout;
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addLayout(panels);
+    layout->addWidget(infoLabel);
+    setLayout(layout);
+
+    settleTimer.setSingleShot(true);
+    settleTimer.setInterval(300);
+    connect(&settleTimer, &QTimer::timeout, this, &JuliaExplorer::chooseCurrent);
+    connect(&previewWatcher, &QFutureWatcher<Preview>::finished, this, &JuliaExplorer::onPreviewFinished);
+}
+
+JuliaExplorer::~JuliaExplorer() {
+    previewPending = false;
+    if (previewControl) previewControl->cancel();
+    previewWatcher.waitForFinished();
+}
+
+void JuliaExplorer::setJuliaView(double realMin, double realMax, double imagMin, double imagMax) {
+    viewRealMin = realMin;
+    viewRealMax = realMax;
+    viewImagMin = imagMin;
+    viewImagMax = imagMax;
+}
+
+void JuliaExplorer::setColorMapIndex(int index) {
+    if (index == colorMapIndex) return;
+    colorMapIndex = index;
+    // 参数平面已经画过时按新的颜色重画
+    if (!planeImage.isNull()) renderParameterPlane();
+}
+
+void JuliaExplorer::showEvent(QShowEvent* event) {
+    QWidget::showEvent(event);
+    // 第一次显示时才计算参数平面
+    if (planeImage.isNull()) renderParameterPlane();
+}
+
+std::complex<double> JuliaExplorer::parameterAt(const QPoint& pos) const {
+    // 与 renderMandelbrotRows 的像素坐标约定相同
+    return {planeRealMin + pos.x() * (planeRealMax - planeRealMin) / panelSize,
+            planeImagMin + pos.y() * (planeImagMax - planeImagMin) / panelSize};
+}
+
+void JuliaExplorer::renderParameterPlane() {
+    std::vector<int> iterations(static_cast<size_t>(panelSize) * panelSize);
+    renderMandelbrotRows(planeRealMin, planeRealMax, planeImagMin, planeImagMax, panelSize, panelSize,
+                         planeMaxIterations, 2.0,
+                         [&](int y) { return iterations.data() + static_cast<size_t>(y) * panelSize; });
+    planeImage = colorIterations(iterations, panelSize, panelSize, planeMaxIterations,
+                                 ColorMap::getRangeColorMapFunction(colorMapIndex));
+    updateMarker();
+}
+
+void JuliaExplorer::updateMarker() {
+    QPixmap pixmap = QPixmap::fromImage(planeImage);
+    if (hasC) {
+        QPainter painter(&pixmap);
+        painter.setPen(Qt::white);
+        int x = static_cast<int>((currentC.real() - planeRealMin) / (planeRealMax - planeRealMin) * panelSize);
+        int y = static_cast<int>((currentC.imag() - planeImagMin) / (planeImagMax - planeImagMin) * panelSize);
+        painter.drawLine(x - 5, y, x + 5, y);
+        painter.drawLine(x, y - 5, x, y + 5);
+    }
+    planeLabel->setPixmap(pixmap);
+}
+
+bool JuliaExplorer::eventFilter(QObject* watched, QEvent* event) {
+    if (watched != planeLabel) return QWidget::eventFilter(watched, event);
+
+    switch (event->type()) {
+    case QEvent::MouseMove:
+    case QEvent::MouseButtonPress: {
+        auto* mouse = static_cast<QMouseEvent*>(event);
+        QPoint pos = mouse->pos();
+        if (pos.x() < 0 || pos.y() < 0 || pos.x() >= panelSize || pos.y() >= panelSize) break;
+        currentC = parameterAt(pos);
+        hasC = true;
+        updateMarker();
+        requestPreview(currentC);
+        // 点击立即生成，悬停则等光标停下
+        if (event->type() == QEvent::MouseButtonPress) {
+            settleTimer.stop();
+            chooseCurrent();
+        }
+        else
+            settleTimer.start();
+        return true;
+    }
+    case QEvent::Leave:
+        // 光标离开参数平面不算停下
+        settleTimer.stop();
+        break;
+    default:
+        break;
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void JuliaExplorer::chooseCurrent() {
+    if (!hasC || (hasChosen && chosenC == currentC)) return;
+    chosenC = currentC;
+    hasChosen = true;
+    emit parameterChosen(currentC.real(), currentC.imag());
+}
+
+void JuliaExplorer::requestPreview(std::complex<double> c) {
+    pendingC = c;
+    previewPending = true;
+    // 正在计算的预览已经过时，取消后由 onPreviewFinished 开始最新的请求
+    if (previewWatcher.isRunning()) {
+        if (previewControl) previewControl->cancel();
+        return;
+    }
+    startPreview();
+}
+
+void JuliaExplorer::startPreview() {
+    previewPending = false;
+    auto control = std::make_shared<RenderControl>();
+    previewControl = control;
+
+    const std::complex<double> c = pendingC;
+    const int size = previewSize;
+    const int maxIterations = previewMaxIterations;
+    const double realMin = viewRealMin, realMax = viewRealMax;
+    const double imagMin = viewImagMin, imagMax = viewImagMax;
+    auto colorMap = ColorMap::getRangeColorMapFunction(colorMapIndex);
+    previewWatcher.setFuture(QtConcurrent::run([=]() {
+        Preview preview;
+        preview.c = c;
+        auto start = std::chrono::steady_clock::now();
+        std::vector<int> iterations(static_cast<size_t>(size) * size);
+        renderQuadraticJuliaPreviewRows(c, realMin, realMax, imagMin, imagMax, size, size, maxIterations, 2.0,
+                                        [&](int y) { return iterations.data() + static_cast<size_t>(y) * size; },
+                                        control.get());
+        preview.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (control->isCancelled()) return preview;
+        preview.image = colorIterations(iterations, size, size, maxIterations, colorMap);
+        preview.completed = true;
+        return preview;
+    }));
+}
+
+void JuliaExplorer::onPreviewFinished() {
+    Preview preview = previewWatcher.result();
+    previewControl.reset();
+    if (preview.completed) {
+        previewLabel->setPixmap(QPixmap::fromImage(preview.image).scaled(panelSize, panelSize));
+        infoLabel->setText(QString("c = %1%2%3i，预览 %4x%4，%5 ms")
+                               .arg(preview.c.real(), 0, 'f', 6)
+                               .arg(preview.c.imag() < 0 ? "-" : "+")
+                               .arg(std::abs(preview.c.imag()), 0, 'f', 6)
+                               .arg(preview.image.width())
+                               .arg(preview.seconds * 1000, 0, 'f', 1));
+        // 超出预算时缩小边长，远低于预算时放大，保持交互帧率
+        if (preview.seconds > previewBudgetSeconds)
+            previewSize = std::max(minPreviewSize, previewSize * 3 / 4);
+        else if (preview.seconds < previewBudgetSeconds / 2)
+            previewSize = std::min(maxPreviewSize, previewSize * 5 / 4);
+    }
+    if (previewPending) startPreview();
+}
@@ -0,0 +1,97 @@
+#ifndef JULIAEXPLORER_H
+#define JULIAEXPLORER_H
+
+#include <QWidget>
+#include <QLabel>
+#include <QImage>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <complex>
+#include <memory>
+#include "juliaengine.h"
+
+/**
+ * Mandelbrot/Julia 联动浏览：左侧是 z^2+c 的参数平面，光标悬停或拖动时选中 c，
+ * 右侧立即显示 z^2+c 的 Julia 集低分辨率预览；光标停下（或点击）后发出 parameterChosen，
+ * 由主界面按当前设置生成全分辨率图像。
+ *
+ * 预览在后台线程中用引擎的渲染线程池计算（单精度内核），光标移动时通过 RenderControl 取消
+ * 正在进行的预览，只保留最新的 c。预览边长按上一次的耗时自动调整，使每帧保持在延迟预算之内。
+ */
+class JuliaExplorer : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit JuliaExplorer(QWidget* parent = nullptr);
+    // 取消并等待正在进行的预览
+    ~JuliaExplorer() override;
+
+    // 预览使用的动力平面范围，与主界面当前画面一致
+    void setJuliaView(double realMin, double realMax, double imagMin, double imagMax);
+    // 颜色映射，见 ColorMap::funcNames
+    void setColorMapIndex(int index);
+
+signals:
+    // 光标在参数平面上停下或点击时发出，(real, imag) 为选中的 c
+    void parameterChosen(double real, double imag);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+
+private:
+    struct Preview {
+        QImage image;
+        std::complex<double> c;
+        double seconds = 0;
+        bool completed = false;
+    };
+
+    // 参数平面像素 pos 对应的 c
+    std::complex<double> parameterAt(const QPoint& pos) const;
+    void renderParameterPlane();
+    // 在参数平面上标出当前的 c
+    void updateMarker();
+    // 发出 parameterChosen，与上一次发出的 c 相同时不再重复发出
+    void chooseCurrent();
+    void requestPreview(std::complex<double> c);
+    void startPreview();
+    void onPreviewFinished();
+
+    // 参数平面的范围和迭代次数
+    double planeRealMin = -2.25;
+    double planeRealMax = 0.75;
+    double planeImagMin = -1.5;
+    double planeImagMax = 1.5;
+    int planeMaxIterations = 256;
+    int panelSize = 320; // 两个面板的边长
+
+    // 预览：边长在 [minPreviewSize, maxPreviewSize] 内按耗时调整
+    double viewRealMin = -1.5;
+    double viewRealMax = 1.5;
+    double viewImagMin = -1.5;
+    double viewImagMax = 1.5;
+    int previewMaxIterations = 256;
+    double previewBudgetSeconds = 0.03; // 每帧预览的计算时间预算
+    int previewSize = 160;
+    int minPreviewSize = 64;
+    int maxPreviewSize = 320;
+    int colorMapIndex = 0;
+
+    QLabel* planeLabel;
+    QLabel* previewLabel;
+    QLabel* infoLabel;
+    QImage planeImage;
+
+    std::complex<double> currentC;
+    bool hasC = false;
+    std::complex<double> chosenC; // 上一次发出 parameterChosen 的 c
+    bool hasChosen = false;
+    std::complex<double> pendingC; // 预览线程忙时最新请求的 c，只保留最后一个
+    bool previewPending = false;
+    std::shared_ptr<RenderControl> previewControl; // 正在进行的预览，用于取消
+    QFutureWatcher<Preview> previewWatcher;
+    QTimer settleTimer; // 光标停下多久后开始全分辨率渲染
+};
+
+#endif // JULIAEXPLORER_H
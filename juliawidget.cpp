@@ -10,9 +10,16 @@
 #include <QScrollBar>
 #include <QGroupBox>
 #include <colormap.h>
+#include "imageexport.h"
+#include "iterationfile.h"
+#include <QFileDialog>
 #include <QShortcut>
 #include <QFile>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
 
 JuliaWidget::JuliaWidget(QWidget* parent)
     : QWidget(parent), width(400), height(800), maxIterations(1000) {
@@ -20,6 +27,11 @@ JuliaWidget::JuliaWidget(QWidget* parent)
     setupUI();
 }
 
+JuliaWidget::~JuliaWidget() {
+    if(densityControl) densityControl->cancel();
+    densityWatcher.waitForFinished();
+}
+
 void JuliaWidget::setupUI() {
     // 主布局
     QVBoxLayout* mainLayout = new QVBoxLayout;
@@ -60,6 +72,64 @@ void JuliaWidget::setupUI() {
     // 将下拉框插入到布局中
     figCfgInputGroupLayout->addLayout(colorSelectLayout);
 
+    // 渲染模式
+    renderModeComboBox = new QComboBox(this);
+    renderModeComboBox->addItem("逃逸时间", EscapeTime);
+    renderModeComboBox->addItem("Buddhabrot（逃逸轨道密度）", Buddhabrot);
+    renderModeComboBox->addItem("Anti-Buddhabrot（不逃逸轨道密度）", AntiBuddhabrot);
+    renderModeComboBox->addItem("参数图集（双击格子选用参数）", ParameterAtlas);
+    renderModeComboBox->addItem("吸引域（按收敛到的吸引子和收敛速度着色）", AttractorBasins);
+    QHBoxLayout* renderModeLayout = new QHBoxLayout;
+    renderModeLayout->addWidget(new QLabel("渲染模式"));
+    renderModeLayout->addWidget(renderModeComboBox);
+    figCfgInputGroupLayout->addLayout(renderModeLayout);
+
+    // 迭代内核
+    kernelComboBox = new QComboBox(this);
+    kernelComboBox->addItem("逐像素（参考）", ReferenceKernel);
+    kernelComboBox->addItem("波前压缩（适合大迭代次数）", WavefrontKernel);
+    kernelComboBox->addItem("区间认证（整块跳过内部和远离边界的区域，仅多项式）", CertifiedKernel);
+    QHBoxLayout* kernelLayout = new QHBoxLayout;
+    kernelLayout->addWidget(new QLabel("迭代内核"));
+    kernelLayout->addWidget(kernelComboBox);
+    figCfgInputGroupLayout->addLayout(kernelLayout);
+
+    // 对称性
+    symmetryCheckBox = new QCheckBox("自动检测函数对称性，只计算基本区域后镜像/旋转");
+    figCfgInputGroupLayout->addWidget(symmetryCheckBox);
+
+    // 平滑着色
+    smoothCheckBox = new QCheckBox("平滑着色（分数逃逸值，消除色带，仅逃逸时间模式）");
+    figCfgInputGroupLayout->addWidget(smoothCheckBox);
+
+    // 续算：只提高最大迭代次数或逃逸半径时，在上一次结果上继续迭代
+    resumeCheckBox = new QCheckBox("提高迭代次数/逃逸半径时续算（仅参考内核且不用对称性时，每像素多占 16 字节）");
+    resumeCheckBox->setChecked(true);
+    figCfgInputGroupLayout->addWidget(resumeCheckBox);
+
+    // 参数图集设置
+    QHBoxLayout* atlasLayoutRow = new QHBoxLayout;
+    atlasLayoutRow->addWidget(new QLabel("图集网格数:"));
+    atlasGridInput = new QLineEdit("16");
+    atlasLayoutRow->addWidget(atlasGridInput);
+    atlasLayoutRow->addWidget(new QLabel("变化 z^k 的系数, k ="));
+    atlasCoeffInput = new QLineEdit("0");
+    atlasLayoutRow->addWidget(atlasCoeffInput);
+    figCfgInputGroupLayout->addLayout(atlasLayoutRow);
+
+    // 保存格式与 PNG 压缩等级
+    QHBoxLayout* saveFormatLayout = new QHBoxLayout;
+    saveFormatLayout->addWidget(new QLabel("保存格式"));
+    saveFormatComboBox = new QComboBox(this);
+    for(int i = 0; i < ImageExport::formatNames.length(); i++)
+        saveFormatComboBox->addItem(ImageExport::formatNames[i], i);
+    saveFormatComboBox->addItem("迭代数据（.jit，可重新上色）", ImageExport::formatNames.length());
+    saveFormatLayout->addWidget(saveFormatComboBox);
+    saveFormatLayout->addWidget(new QLabel("PNG压缩等级(0-9):"));
+    pngCompressionInput = new QLineEdit("6");
+    saveFormatLayout->addWidget(pngCompressionInput);
+    figCfgInputGroupLayout->addLayout(saveFormatLayout);
+
     // 连接下拉框的信号到槽函数
     //connect(colorMapComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(onColorMapChanged(int)));
 
@@ -96,6 +166,62 @@ void JuliaWidget::setupUI() {
 
     figCfgInputGroupLayout->addLayout(rangeLayout);
 
+    // 自适应抗锯齿
+    adaptiveAACheckBox = new QCheckBox("自适应抗锯齿（仅细化边缘像素）");
+    figCfgInputGroupLayout->addWidget(adaptiveAACheckBox);
+    // 抗锯齿的追加采样是整数迭代次数，与平滑着色不能同时使用
+    connect(adaptiveAACheckBox, &QCheckBox::toggled, this, [this](bool checked){
+        if(checked) smoothCheckBox->setChecked(false);
+        smoothCheckBox->setEnabled(!checked);
+    });
+
+    // 渲染线程设置
+    QHBoxLayout* threadLayout = new QHBoxLayout;
+    threadLayout->addWidget(new QLabel(QString("线程数(0=自动, 可用 %1):").arg(defaultRenderThreadCount())));
+    threadCountInput = new QLineEdit("0");
+    threadLayout->addWidget(threadCountInput);
+    pinThreadsCheckBox = new QCheckBox("绑定CPU核心");
+    threadLayout->addWidget(pinThreadsCheckBox);
+    figCfgInputGroupLayout->addLayout(threadLayout);
+
+    // 交互帧的帧时间预算
+    QHBoxLayout* frameBudgetLayout = new QHBoxLayout;
+    frameBudgetCheckBox = new QCheckBox("移动/缩放时按帧时间预算降低分辨率和迭代次数，预算(ms):");
+    frameBudgetCheckBox->setChecked(true);
+    frameBudgetLayout->addWidget(frameBudgetCheckBox);
+    frameBudgetInput = new QLineEdit("50");
+    frameBudgetLayout->addWidget(frameBudgetInput);
+    figCfgInputGroupLayout->addLayout(frameBudgetLayout);
+    refineTimer = new QTimer(this);
+    refineTimer->setSingleShot(true);
+    refineTimer->setInterval(400);
+    connect(refineTimer, &QTimer::timeout, this, [this](){ onGenerateButtonClicked(false); });
+
+    // 后台导出：以更低的优先级渲染当前画面的高分辨率版本
+    QHBoxLayout* exportLayout = new QHBoxLayout;
+    exportLayout->addWidget(new QLabel("导出分辨率:"));
+    exportResolutionInput = new QLineEdit("8192");
+    exportLayout->addWidget(exportResolutionInput);
+    exportLayout->addWidget(new QLabel("检查点间隔(秒):"));
+    exportCheckpointInput = new QLineEdit("60");
+    exportLayout->addWidget(exportCheckpointInput);
+    QPushButton* exportButton = new QPushButton("后台导出当前画面");
+    exportLayout->addWidget(exportButton);
+    QPushButton* cancelExportButton = new QPushButton("取消所选");
+    exportLayout->addWidget(cancelExportButton);
+    figCfgInputGroupLayout->addLayout(exportLayout);
+    exportList = new QListWidget;
+    exportList->setMaximumHeight(80);
+    figCfgInputGroupLayout->addWidget(exportList);
+
+    exportQueue = new ExportQueue(this);
+    connect(exportQueue, &ExportQueue::jobChanged, this, &JuliaWidget::onExportJobChanged);
+    connect(exportButton, &QPushButton::clicked, this, &JuliaWidget::exportCurrentView);
+    connect(cancelExportButton, &QPushButton::clicked, this, [this](){
+        for(auto* item : exportList->selectedItems())
+            exportQueue->cancel(item->data(Qt::UserRole).toInt());
+    });
+
     figCfgInputGroup->setLayout(figCfgInputGroupLayout);
     figCfgInputGroup->setMaximumWidth(500);
 
@@ -113,17 +239,49 @@ void JuliaWidget::setupUI() {
     generateButton->setMaximumWidth(500);
     mainLayout->addWidget(generateButton);
 
+    // 取消后台进行的轨道密度计算
+    cancelRenderButton = new QPushButton("取消计算");
+    cancelRenderButton->setMaximumWidth(500);
+    cancelRenderButton->setEnabled(false);
+    mainLayout->addWidget(cancelRenderButton);
+    connect(cancelRenderButton, &QPushButton::clicked, this, [this](){
+        if(densityControl) densityControl->cancel();
+    });
+    connect(&densityWatcher, &QFutureWatcher<DensityResult>::finished, this, &JuliaWidget::onDensityFinished);
+
+    // 加载迭代数据，直接重新上色而不重新计算
+    loadButton = new QPushButton("加载迭代数据 (.jit)");
+    loadButton->setMaximumWidth(500);
+    mainLayout->addWidget(loadButton);
+    connect(loadButton, &QPushButton::clicked, this, [this](){
+        QString path = QFileDialog::getOpenFileName(this, "加载迭代数据", QString(), "迭代数据 (*.jit)");
+        if(!path.isEmpty()) loadIterationFile(path);
+    });
+
     // 显示图像名称
     displayLabel = new QLabel(
         "点击上面按钮生成图像，图像需要一段时间生成，程序可能会无响应，请耐心等待。\n"
         "注意：请保证输入的只包含完全展开的多项式或有理函数，本程序无法处理其它复杂格式。\n"
         "提示：光标不在输入框内时，你可以通过上下左右移动图像范围，-/= 缩放图像；\n"
-        "Ctrl+S保存图像，Ctrl+D生成图像（但不保存）；\n"
+        "Ctrl+S保存图像，Ctrl+D生成图像（但不保存），Ctrl+E在后台导出高分辨率图像；\n"
         "下图为不同颜色映射函数的样式参考。");
     displayLabel->setWordWrap(true);
 
     mainLayout->addWidget(displayLabel);
 
+    // Mandelbrot/Julia 联动浏览，默认隐藏
+    explorerCheckBox = new QCheckBox("Mandelbrot/Julia 联动浏览（悬停预览 z^2+c，停下或点击后生成）");
+    mainLayout->addWidget(explorerCheckBox);
+    explorer = new JuliaExplorer;
+    explorer->setVisible(false);
+    mainLayout->addWidget(explorer);
+    connect(explorerCheckBox, &QCheckBox::toggled, this, [this](bool checked){
+        explorer->setJuliaView(realCenter - range/2, realCenter + range/2, imagCenter - range/2, imagCenter + range/2);
+        explorer->setColorMapIndex(colorMapComboBox->currentIndex());
+        explorer->setVisible(checked);
+    });
+    connect(explorer, &JuliaExplorer::parameterChosen, this, &JuliaWidget::onExplorerParameterChosen);
+
     imageLabel = new QLabel("暂无图像");
     imageLabel->setAlignment(Qt::AlignCenter);
     scrollArea = new QScrollArea;
@@ -142,18 +300,83 @@ void JuliaWidget::setupUI() {
     setLayout(mainLayout);
 }
 
-void JuliaWidget::onGenerateButtonClicked(bool saveImage) {
-    if( // 参数改变时才重新计算矩阵
+bool JuliaWidget::needsRecompute(int requestedResolution, int requestedMaxIterations) const {
+    return
         func_str != funcInput->text().toStdString() ||
-        resolution != resolutionInput->text().toInt() ||
-        maxIterations != maxIterInput->text().toInt() ||
+        resolution != requestedResolution ||
+        maxIterations != requestedMaxIterations ||
         escapeRadius != escapeRadiusInput->text().toDouble() ||
         abs(realCenter - realCenterInput->text().toDouble()) > epsilon ||
         abs(imagCenter - imagCenterInput->text().toDouble()) > epsilon ||
-        abs(range - rangeInput->text().toDouble()) > epsilon
+        abs(range - rangeInput->text().toDouble()) > epsilon ||
+        renderMode != renderModeComboBox->currentIndex() ||
+        kernel != kernelComboBox->currentIndex() ||
+        useSymmetry != symmetryCheckBox->isChecked() ||
+        useSmooth != smoothCheckBox->isChecked() ||
+        (renderMode == ParameterAtlas && (
+            atlasLayout.columns != atlasGridInput->text().toInt() ||
+            atlasLayout.coeffIndex != atlasCoeffInput->text().toInt()));
+}
+
+void JuliaWidget::onGenerateButtonClicked(bool saveImage) {
+    // 线程设置不影响计算结果，线程池只在设置变化时重建
+    RenderThreadSettings threadSettings;
+    threadSettings.threadCount = std::max(0, threadCountInput->text().toInt());
+    threadSettings.pinThreads = pinThreadsCheckBox->isChecked();
+    setRenderThreadSettings(threadSettings);
+
+    // 保存总是按输入框中的完整设置：取消等待中的重新生成，当前若是降质的交互帧会在下面重新计算
+    if(saveImage){
+        refineTimer->stop();
+        frameResolution = frameMaxIterations = -1;
+    }
+
+    // 交互帧临时使用控制器选择的分辨率和最大迭代次数，见 interactiveGenerate
+    const int requestedResolution = frameResolution > 0 ? frameResolution : resolutionInput->text().toInt();
+    const int requestedMaxIterations = frameMaxIterations > 0 ? frameMaxIterations : maxIterInput->text().toInt();
+
+    // 轨道密度正在后台计算：参数未变时等它完成后再上色（和保存），否则放弃它按新参数计算
+    if(densityControl){
+        if(!needsRecompute(requestedResolution, requestedMaxIterations)){
+            densitySaveRequested = densitySaveRequested || saveImage;
+            return;
+        }
+        abandonDensityRender();
+    }
+    // 逃逸时间模式从头计算时记录耗时，用于估计交互帧的吞吐量
+    auto computeStart = std::chrono::steady_clock::now();
+    bool measured = false;
+
+    // 只提高了最大迭代次数和/或逃逸半径，其余参数不变时，在上一次的结果上续算
+    const int newMaxIterations = requestedMaxIterations;
+    const double newEscapeRadius = escapeRadiusInput->text().toDouble();
+    resumeInfo.clear();
+    if(
+        resumeCheckBox->isChecked() && !escapeState.empty() && juliaFunc &&
+        renderMode == EscapeTime && renderModeComboBox->currentIndex() == EscapeTime &&
+        func_str == funcInput->text().toStdString() &&
+        resolution == requestedResolution &&
+        abs(realCenter - realCenterInput->text().toDouble()) <= epsilon &&
+        abs(imagCenter - imagCenterInput->text().toDouble()) <= epsilon &&
+        abs(range - rangeInput->text().toDouble()) <= epsilon &&
+        kernel == kernelComboBox->currentIndex() &&
+        useSymmetry == symmetryCheckBox->isChecked() &&
+        useSmooth == smoothCheckBox->isChecked() &&
+        newMaxIterations >= maxIterations && newEscapeRadius >= escapeRadius &&
+        (newMaxIterations != maxIterations || newEscapeRadius != escapeRadius)
     ){
-        resolution = resolutionInput->text().toInt();
-        maxIterations = maxIterInput->text().toInt();
+        long long continued = continueJuliaState(escapeState, juliaFunc, newMaxIterations, newEscapeRadius);
+        maxIterations = newMaxIterations;
+        escapeRadius = newEscapeRadius;
+        JuliaMatrix = escapeState.iterations;
+        if(useSmooth)
+            smoothMatrix = smoothEscapeValues(escapeState, juliaFunc, escapeDegree(parseRationalFunction(func_str)));
+        resumeInfo = QString("（续算了 %1% 的像素）")
+                         .arg(100.0 * continued / std::max(1LL, static_cast<long long>(width) * height), 0, 'f', 1);
+    }
+    else if(needsRecompute(requestedResolution, requestedMaxIterations)){ // 参数改变时才重新计算矩阵
+        resolution = requestedResolution;
+        maxIterations = requestedMaxIterations;
         func_str = funcInput->text().toStdString();
         escapeRadius = escapeRadiusInput->text().toDouble();
 
@@ -161,6 +384,14 @@ void JuliaWidget::onGenerateButtonClicked(bool saveImage) {
         realCenter = realCenterInput->text().toDouble();
         imagCenter = imagCenterInput->text().toDouble();
         range = rangeInput->text().toDouble();
+        renderMode = renderModeComboBox->currentIndex();
+        kernel = kernelComboBox->currentIndex();
+        useSymmetry = symmetryCheckBox->isChecked();
+        useSmooth = smoothCheckBox->isChecked();
+        symmetryInfo.clear();
+        escapeState = EscapeTimeState();
+        smoothMatrix.clear();
+        basinMatrix.clear();
 
         width = resolution;
         height = resolution;
@@ -170,12 +401,101 @@ void JuliaWidget::onGenerateButtonClicked(bool saveImage) {
             auto func = getRationalFunctionLambda(func_str);
             func_str = func.second;
             funcInput->setText(func.second.c_str());
-
-            // 计算出julia矩阵
-            JuliaMatrix = generateJuliaMatrix(
-                realCenter - range/2, realCenter + range/2, imagCenter - range/2, imagCenter + range/2,
-                width, height, func.first, maxIterations, escapeRadius
-                );
+            juliaFunc = func.first;
+
+            if(renderMode == ParameterAtlas){
+                // 画面中心和范围作为参数平面，resolution 为整张图集的边长
+                atlasLayout.columns = atlasLayout.rows = std::max(1, atlasGridInput->text().toInt());
+                atlasLayout.cellSize = std::max(1, resolution / atlasLayout.columns);
+                atlasLayout.coeffIndex = std::max(0, atlasCoeffInput->text().toInt());
+                atlasLayout.paramRealMin = realCenter - range/2;
+                atlasLayout.paramRealMax = realCenter + range/2;
+                atlasLayout.paramImagMin = imagCenter - range/2;
+                atlasLayout.paramImagMax = imagCenter + range/2;
+                JuliaMatrix = generateParameterAtlas(
+                    parseRationalFunction(func_str), atlasLayout,
+                    -atlasViewRange/2, atlasViewRange/2, -atlasViewRange/2, atlasViewRange/2,
+                    maxIterations, escapeRadius
+                    );
+            }
+            else if(renderMode == EscapeTime && resumeCheckBox->isChecked() && kernel == ReferenceKernel && !useSymmetry){
+                // 保存每个像素停止时的 z，之后提高迭代次数或逃逸半径时可以续算。
+                // 只有参考内核逐像素迭代到底，其余内核和对称性走下面的库接口，不保存续算状态
+                escapeState = generateJuliaState(
+                    realCenter - range/2, realCenter + range/2, imagCenter - range/2, imagCenter + range/2,
+                    width, height, juliaFunc, maxIterations, escapeRadius
+                    );
+                JuliaMatrix = escapeState.iterations;
+                // 平滑值由每个像素停止时的 z 得到，不需要重新迭代
+                if(useSmooth)
+                    smoothMatrix = smoothEscapeValues(escapeState, juliaFunc, escapeDegree(parseRationalFunction(func_str)));
+                measured = true;
+            }
+            else if(renderMode == EscapeTime){
+                // 计算出julia矩阵：通过引擎的库接口直接写入 JuliaMatrix 的各行
+                JuliaRenderParams params;
+                params.function = func_str;
+                params.realMin = realCenter - range/2;
+                params.realMax = realCenter + range/2;
+                params.imagMin = imagCenter - range/2;
+                params.imagMax = imagCenter + range/2;
+                params.width = width;
+                params.height = height;
+                params.maxIterations = maxIterations;
+                params.escapeRadius = escapeRadius;
+                params.kernel = static_cast<IterationKernel>(kernel);
+                params.useSymmetry = useSymmetry;
+                params.smooth = useSmooth;
+
+                JuliaMatrix.assign(height, std::vector<int>(width));
+                std::vector<int32_t*> rows(height);
+                for(int y = 0; y < height; ++y)
+                    rows[y] = JuliaMatrix[y].data();
+                JuliaRenderTarget target;
+                target.iterationRows = rows.data();
+                std::vector<float*> smoothRows;
+                if(useSmooth){
+                    smoothMatrix.assign(height, std::vector<float>(width));
+                    for(auto& row : smoothMatrix)
+                        smoothRows.push_back(row.data());
+                    target.smoothRows = smoothRows.data();
+                }
+
+                JuliaRenderStats stats;
+                juliaRender(params, target, {}, &stats);
+                measured = true;
+                if(useSymmetry)
+                    symmetryInfo = QString("（%1，实际计算了 %2% 的像素）")
+                                       .arg(QString::fromStdString(describeSymmetry(analyzeSymmetry(parseRationalFunction(func_str)))))
+                                       .arg(100.0 * stats.computedPixels / std::max(1LL, static_cast<long long>(width) * height), 0, 'f', 1);
+                else if(kernel == CertifiedKernel)
+                    symmetryInfo = QString("（区间认证，逐像素计算了 %1% 的像素）")
+                                       .arg(100.0 * stats.computedPixels / std::max(1LL, static_cast<long long>(width) * height), 0, 'f', 1);
+            }
+            else if(renderMode == AttractorBasins){
+                // 先求出吸引不动点，轨道进入某个吸引子的捕获圆盘即停止
+                RationalAttractors attractors = findRationalAttractors(parseRationalFunction(func_str));
+                BasinMatrix basins = generateRationalBasins(
+                    realCenter - range/2, realCenter + range/2, imagCenter - range/2, imagCenter + range/2,
+                    width, height, attractors, maxIterations, escapeRadius
+                    );
+                JuliaMatrix = std::move(basins.steps);
+                basinMatrix = std::move(basins.basins);
+                basinCount = attractors.infinityIndex() + 1;
+                long long converged = 0;
+                for(auto& i:basinMatrix)
+                    for(auto& j:i)
+                        if(j >= 0) ++converged;
+                symmetryInfo = QString("（%1 个吸引不动点%2，%3% 的像素收敛）")
+                                   .arg(static_cast<int>(attractors.finite.size()))
+                                   .arg(attractors.infinityAttracting ? "，无穷远点吸引" : "")
+                                   .arg(100.0 * converged / std::max(1LL, static_cast<long long>(width) * height), 0, 'f', 1);
+            }
+            else{
+                // 轨道密度，矩阵中保存的是每个像素被轨道经过的次数。采样数很大，在后台计算，完成后再上色
+                startDensityRender(saveImage);
+                return;
+            }
 
         } catch (const std::exception& e) {
             // 4. 捕获错误并弹窗
@@ -186,33 +506,123 @@ void JuliaWidget::onGenerateButtonClicked(bool saveImage) {
 
     }
 
+    frameInfo.clear();
+    if(measured && !JuliaMatrix.empty()){
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - computeStart).count();
+        long long pixels = 0, iterations = 0, cappedPixels = 0;
+        for(auto& i:JuliaMatrix)
+            for(auto& j:i){
+                ++pixels;
+                iterations += j;
+                if(j >= maxIterations) ++cappedPixels;
+            }
+        frameQuality.record(pixels, iterations, cappedPixels, maxIterations, seconds);
+        frameInfo = QString("（%1%2px，最大迭代 %3，用时 %4 ms%5，%6 M 迭代/秒）")
+                        .arg(frameResolution > 0 ? "交互帧 " : "")
+                        .arg(resolution)
+                        .arg(maxIterations)
+                        .arg(seconds * 1000, 0, 'f', 1)
+                        .arg(frameResolution > 0 ? QString("，预计 %1 ms").arg(framePredictedSeconds * 1000, 0, 'f', 1) : QString())
+                        .arg(frameQuality.throughput() / 1e6, 0, 'f', 1);
+    }
+
+    // 联动浏览的预览与当前画面保持一致
+    explorer->setJuliaView(realCenter - range/2, realCenter + range/2, imagCenter - range/2, imagCenter + range/2);
+    explorer->setColorMapIndex(colorMapComboBox->currentIndex());
+
     int minIter = maxIterations; // 最小的 迭代次数
     for(auto& i:JuliaMatrix)
         for(auto& j:i)
             if(j < minIter)
                 minIter = j;
 
+    // 平滑着色时颜色范围从最小的平滑值开始
+    // 交互帧不做抗锯齿，停下后的完整渲染再细化
+    const bool adaptiveAA = renderMode == EscapeTime && adaptiveAACheckBox->isChecked() && frameResolution <= 0 &&
+                            juliaFunc && !JuliaMatrix.empty();
+    // 抗锯齿按整数迭代次数上色，颜色范围也从最小的迭代次数开始
+    const bool smoothColoring = renderMode == EscapeTime && useSmooth && !smoothMatrix.empty() && !adaptiveAA;
+    float minSmooth = static_cast<float>(maxIterations);
+    if(smoothColoring)
+        for(auto& i:smoothMatrix)
+            for(auto& j:i)
+                minSmooth = std::min(minSmooth, j);
+
     // 获取下拉框的数据
-    colorMapFunc = ColorMap::getColorMapFunction(colorMapComboBox->currentIndex(), minIter, maxIterations);
+    if(smoothColoring)
+        colorMapFunc = ColorMap::getColorMapFunction(colorMapComboBox->currentIndex(), minSmooth, maxIterations);
+    else if(renderMode == EscapeTime || renderMode == ParameterAtlas || renderMode == AttractorBasins)
+        colorMapFunc = ColorMap::getColorMapFunction(colorMapComboBox->currentIndex(), minIter, maxIterations);
+    else{
+        // 轨道密度的动态范围很大，取平方根后再映射颜色
+        int maxCount = 1;
+        for(auto& i:JuliaMatrix)
+            for(auto& j:i)
+                maxCount = std::max(maxCount, j);
+        colorMapFunc = ColorMap::getDensityColorMapFunction(colorMapComboBox->currentIndex(), maxCount);
+    }
 
     //originalImage = saveJuliaImage(matrix, filename, createHSVGradientFunction(HSV1[0], HSV1[1], HSV1[2], HSV2[0], HSV2[1], HSV2[2], maxIterations));
-    originalImage = getJuliaImage(JuliaMatrix, colorMapFunc);
+    int refinedPixels = -1;
+    if(adaptiveAA){
+        originalImage = getJuliaImageAdaptiveAA(
+            JuliaMatrix,
+            realCenter - range/2, realCenter + range/2, imagCenter - range/2, imagCenter + range/2,
+            juliaFunc, maxIterations, escapeRadius, colorMapFunc,
+            aaThreshold, aaExtraSamples, &refinedPixels);
+    }
+    else if(smoothColoring)
+        originalImage = getJuliaImage(smoothMatrix, colorMapFunc);
+    else if(renderMode == AttractorBasins && !basinMatrix.empty())
+        originalImage = getBasinImage(JuliaMatrix, basinMatrix, basinCount);
+    else
+        originalImage = getJuliaImage(JuliaMatrix, colorMapFunc);
+    QString aaInfo = refinedPixels >= 0 ? QString("（抗锯齿细化了 %1 个像素）").arg(refinedPixels) : "";
 
     if(saveImage){
         // 生成文件名
         std::ostringstream oss;
-        auto f_name = std::regex_replace(std::regex_replace(func_str, std::regex("[ \\^]"), ""), std::regex("/"), "div");
-        oss << "julia_" << f_name
-            << "_" << maxIterations << "_"
-            << resolution << "p_" << colorMapComboBox->currentText().toStdString() << "_z("
-            << realCenter << "," << imagCenter <<")_"<< range
-            << ".png";
-        std::string filename = oss.str();
-        originalImage.save(QString::fromStdString(filename));
-        displayLabel->setText("图像已保存： " + QString::fromStdString(filename));
+        oss << outputBaseName(resolution, maxIterations)
+            << (refinedPixels >= 0 ? "_aa" : "");
+        // 最后一项为迭代数据，其余为 ImageExport 支持的图像格式
+        bool saveIterations = saveFormatComboBox->currentIndex() == ImageExport::formatNames.length();
+        auto format = static_cast<ImageFileFormat>(saveFormatComboBox->currentIndex());
+        if(!saveIterations && format == ImageFileFormat::RawRGBA)
+            oss << "_" << originalImage.width() << "x" << originalImage.height();
+        QString filename = QString::fromStdString(oss.str()) + (saveIterations ? ".jit" : ImageExport::suffix(format));
+
+        // 在后台线程中编码保存，GUI 立即返回，完成后在 displayLabel 中报告
+        auto* watcher = new QFutureWatcher<bool>(this);
+        connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, filename](){
+            --pendingSaves;
+            if(watcher->result())
+                displayLabel->setText("图像已保存： " + filename);
+            else
+                displayLabel->setText("图像保存失败： " + filename);
+            watcher->deleteLater();
+        });
+        ++pendingSaves;
+        if(saveIterations){
+            // 迭代矩阵需要复制一份，之后 JuliaMatrix 可能被新的计算覆盖
+            IterationFileParams params = currentIterationFileParams();
+            auto matrix = JuliaMatrix;
+            auto basins = params.basinCount > 0 ? basinMatrix : std::vector<std::vector<int>>();
+            watcher->setFuture(QtConcurrent::run([matrix = std::move(matrix), basins = std::move(basins), params, filename](){
+                return IterationFile::write(filename, matrix, params, basins);
+            }));
+        }
+        else{
+            // QImage 是隐式共享的，复制给后台线程不会拷贝像素
+            int compressionLevel = pngCompressionInput->text().toInt();
+            QImage image = originalImage;
+            watcher->setFuture(QtConcurrent::run([image, filename, format, compressionLevel](){
+                return ImageExport::save(image, filename, format, compressionLevel);
+            }));
+        }
+        displayLabel->setText(QString("正在后台保存（%1 个任务）： ").arg(pendingSaves) + filename + aaInfo);
     }
     else{
-        displayLabel->setText("完成计算");
+        displayLabel->setText("完成计算" + aaInfo + symmetryInfo + resumeInfo + frameInfo);
     }
 
     // 加载并显示图像
@@ -276,3 +686,285 @@ void JuliaWidget::mouseReleaseEvent(QMouseEvent* event) {
         isDragging = false;
     }
 }
+
+void JuliaWidget::mouseDoubleClickEvent(QMouseEvent* event) {
+    if (renderMode != ParameterAtlas || JuliaMatrix.empty() || originalImage.isNull())
+        return;
+
+    // 将点击位置换算到原始图集图像的像素坐标（图像在 imageLabel 中居中显示）
+    QSize shown = imageLabel->pixmap().size();
+    if (shown.isEmpty()) return;
+    QPoint p = imageLabel->mapFrom(this, event->pos());
+    p -= QPoint((imageLabel->width() - shown.width()) / 2, (imageLabel->height() - shown.height()) / 2);
+    int px = p.x() * originalImage.width() / shown.width();
+    int py = p.y() * originalImage.height() / shown.height();
+    if (px < 0 || py < 0 || px >= originalImage.width() || py >= originalImage.height())
+        return;
+
+    int col = px / atlasLayout.cellSize;
+    int row = py / atlasLayout.cellSize;
+    if (col >= atlasLayout.columns || row >= atlasLayout.rows)
+        return;
+
+    // 用该格的参数替换函数中的系数，切回逃逸时间模式并绘制默认范围
+    try {
+        auto f = withCoefficient(parseRationalFunction(func_str), atlasLayout.coeffIndex,
+                                 atlasCellParameter(atlasLayout, col, row));
+        funcInput->setText(QString::fromStdString(f.str));
+    } catch (...) {
+        return;
+    }
+    renderModeComboBox->setCurrentIndex(EscapeTime);
+    realCenterInput->setText("0");
+    imagCenterInput->setText("0");
+    rangeInput->setText(QString::number(atlasViewRange));
+    onGenerateButtonClicked(false);
+}
+
+std::string JuliaWidget::outputBaseName(int pixels, int iterations) const {
+    auto f_name = std::regex_replace(std::regex_replace(func_str, std::regex("[ \\^]"), ""), std::regex("/"), "div");
+    const char* prefixes[] = {"julia_", "buddhabrot_", "antibuddhabrot_", "atlas_", "basins_"};
+    std::ostringstream oss;
+    oss << prefixes[renderMode] << f_name
+        << "_" << iterations << "_"
+        << pixels << "p_" << colorMapComboBox->currentText().toStdString() << "_z("
+        << realCenter << "," << imagCenter <<")_"<< range;
+    return oss.str();
+}
+
+void JuliaWidget::exportCurrentView() {
+    if(renderMode != EscapeTime || JuliaMatrix.empty()){
+        displayLabel->setText("后台导出只支持逃逸时间模式，请先生成图像");
+        return;
+    }
+    int pixels = exportResolutionInput->text().toInt();
+    if(pixels <= 0){
+        displayLabel->setText("导出分辨率必须为正数");
+        return;
+    }
+    // 与保存相同：导出总是按输入框中的完整设置，当前画面可能是降低了最大迭代次数的交互帧
+    refineTimer->stop();
+
+    // 复制当前画面的参数，之后继续浏览不影响导出
+    JuliaRenderParams params;
+    params.function = func_str;
+    params.realMin = realCenter - range/2;
+    params.realMax = realCenter + range/2;
+    params.imagMin = imagCenter - range/2;
+    params.imagMax = imagCenter + range/2;
+    params.width = pixels;
+    params.height = pixels;
+    params.maxIterations = maxIterInput->text().toInt();
+    params.escapeRadius = escapeRadiusInput->text().toDouble();
+    params.kernel = static_cast<IterationKernel>(kernel);
+    params.useSymmetry = useSymmetry;
+    params.smooth = useSmooth;
+
+    // 导出总是保存图像，选择迭代数据格式时保存为 PNG
+    auto format = ImageFileFormat::PNG;
+    if(saveFormatComboBox->currentIndex() < ImageExport::formatNames.length())
+        format = static_cast<ImageFileFormat>(saveFormatComboBox->currentIndex());
+    QString filename = QString::fromStdString(outputBaseName(pixels, params.maxIterations));
+    if(format == ImageFileFormat::RawRGBA)
+        filename += QString("_%1x%1").arg(pixels);
+    filename += ImageExport::suffix(format);
+
+    // 文件名由画面参数决定，同一画面重新导出时会从上次的检查点继续
+    exportQueue->enqueue(params, colorMapComboBox->currentIndex(), format,
+                         pngCompressionInput->text().toInt(), filename,
+                         std::max(0.0, exportCheckpointInput->text().toDouble()));
+}
+
+void JuliaWidget::interactiveGenerate() {
+    // 控制器按逃逸时间的吞吐量校准，轨道密度、参数图集和吸引域的耗时规律不同，不降低质量
+    if(!frameBudgetCheckBox->isChecked() || renderModeComboBox->currentIndex() != EscapeTime){
+        onGenerateButtonClicked(false);
+        return;
+    }
+    FrameQuality quality = frameQuality.choose(resolutionInput->text().toInt(), maxIterInput->text().toInt(),
+                                               frameBudgetInput->text().toDouble() / 1000);
+    frameResolution = quality.resolution;
+    frameMaxIterations = quality.maxIterations;
+    framePredictedSeconds = quality.predictedSeconds;
+    onGenerateButtonClicked(false);
+    frameResolution = frameMaxIterations = -1;
+    // 连续操作时不断推迟，停下后按输入框中的设置生成
+    refineTimer->start();
+}
+
+void JuliaWidget::onExplorerParameterChosen(double real, double imag) {
+    funcInput->setText(QString("z^2+(%1%2%3i)")
+                           .arg(real, 0, 'f', 10)
+                           .arg(imag < 0 ? "-" : "+")
+                           .arg(std::abs(imag), 0, 'f', 10));
+    renderModeComboBox->setCurrentIndex(EscapeTime);
+    // 与移动、缩放一样按帧时间预算生成，连续选定时由 refineTimer 合并为一次完整渲染
+    interactiveGenerate();
+}
+
+void JuliaWidget::startDensityRender(bool saveImage) {
+    JuliaMatrix.clear();
+    const int generation = ++densityGeneration;
+    densitySaveRequested = saveImage;
+    // 进度在渲染线程中报告，转到界面线程显示
+    auto control = std::make_shared<RenderControl>([this, generation](double fraction){
+        QMetaObject::invokeMethod(this, [this, generation, fraction](){
+            if(generation == densityGeneration)
+                displayLabel->setText(QString("正在计算轨道密度 %1%，可点击“取消计算”").arg(fraction * 100, 0, 'f', 1));
+        }, Qt::QueuedConnection);
+        return true;
+    });
+    densityControl = control;
+    cancelRenderButton->setEnabled(true);
+
+    const double realMin = realCenter - range/2, realMax = realCenter + range/2;
+    const double imagMin = imagCenter - range/2, imagMax = imagCenter + range/2;
+    const int w = width, h = height, iterations = maxIterations;
+    const double radius = escapeRadius;
+    const long long samples = static_cast<long long>(width) * height * orbitSamplesPerPixel;
+    const bool anti = renderMode == AntiBuddhabrot;
+    auto func = juliaFunc;
+    densityWatcher.setFuture(QtConcurrent::run([=](){
+        DensityResult result;
+        result.generation = generation;
+        result.matrix = generateOrbitDensityMatrix(realMin, realMax, imagMin, imagMax, w, h, func,
+                                                   iterations, radius, samples, anti, true, 1, control.get());
+        result.completed = !control->isCancelled();
+        return result;
+    }));
+    displayLabel->setText("正在计算轨道密度，可点击“取消计算”");
+}
+
+void JuliaWidget::abandonDensityRender() {
+    if(densityControl) densityControl->cancel();
+    densityControl.reset();
+    ++densityGeneration;
+    densitySaveRequested = false;
+    cancelRenderButton->setEnabled(false);
+}
+
+void JuliaWidget::onDensityFinished() {
+    DensityResult result = densityWatcher.result();
+    if(result.generation != densityGeneration) return; // 已被新的计算取代
+    densityControl.reset();
+    cancelRenderButton->setEnabled(false);
+    const bool save = densitySaveRequested;
+    densitySaveRequested = false;
+    if(!result.completed){
+        renderMode = -1; // 矩阵不完整，下次生成时重新计算
+        displayLabel->setText("已取消轨道密度计算");
+        return;
+    }
+    JuliaMatrix = std::move(result.matrix);
+    onGenerateButtonClicked(save);
+}
+
+void JuliaWidget::onExportJobChanged(int id) {
+    ExportJob job = exportQueue->job(id);
+    QListWidgetItem* item = nullptr;
+    for(int i = 0; i < exportList->count(); ++i)
+        if(exportList->item(i)->data(Qt::UserRole).toInt() == id)
+            item = exportList->item(i);
+    if(!item){
+        item = new QListWidgetItem(exportList);
+        item->setData(Qt::UserRole, id);
+    }
+    item->setText(ExportQueue::describe(job));
+}
+
+IterationFileParams JuliaWidget::currentIterationFileParams() const {
+    IterationFileParams params;
+    params.function = func_str;
+    params.realMin = realCenter - range/2;
+    params.realMax = realCenter + range/2;
+    params.imagMin = imagCenter - range/2;
+    params.imagMax = imagCenter + range/2;
+    params.height = JuliaMatrix.size();
+    params.width = JuliaMatrix.empty() ? 0 : JuliaMatrix[0].size();
+    params.maxIterations = maxIterations;
+    params.escapeRadius = escapeRadius;
+    params.renderMode = renderMode;
+    params.atlasColumns = atlasLayout.columns;
+    params.atlasCoeffIndex = atlasLayout.coeffIndex;
+    params.minValue = maxIterations;
+    params.maxValue = 0;
+    // 吸引域模式同时保存每个像素所属的吸引子
+    if(renderMode == AttractorBasins && !basinMatrix.empty())
+        params.basinCount = basinCount;
+    for(auto& i:JuliaMatrix)
+        for(auto& j:i){
+            params.minValue = std::min(params.minValue, j);
+            params.maxValue = std::max(params.maxValue, j);
+        }
+    return params;
+}
+
+void JuliaWidget::loadIterationFile(const QString& path) {
+    abandonDensityRender();
+    IterationFile file;
+    if(!file.open(path)){
+        QMessageBox::critical(this, "加载失败", QString("无法读取迭代数据：\n%1").arg(file.errorString()));
+        return;
+    }
+    const IterationFileParams& params = file.params();
+
+    // 恢复参数，并同步缓存的参数，使 onGenerateButtonClicked 直接重新上色
+    func_str = params.function;
+    maxIterations = params.maxIterations;
+    escapeRadius = params.escapeRadius;
+    realCenter = (params.realMin + params.realMax) / 2;
+    imagCenter = (params.imagMin + params.imagMax) / 2;
+    range = params.realMax - params.realMin;
+    renderMode = params.renderMode;
+    resolution = params.width;
+    width = params.width;
+    height = params.height;
+    atlasLayout.columns = atlasLayout.rows = std::max(1, params.atlasColumns);
+    atlasLayout.cellSize = std::max(1, params.width / atlasLayout.columns);
+    atlasLayout.coeffIndex = params.atlasCoeffIndex;
+    atlasLayout.paramRealMin = params.realMin;
+    atlasLayout.paramRealMax = params.realMax;
+    atlasLayout.paramImagMin = params.imagMin;
+    atlasLayout.paramImagMax = params.imagMax;
+
+    funcInput->setText(QString::fromStdString(func_str));
+    resolutionInput->setText(QString::number(resolution));
+    maxIterInput->setText(QString::number(maxIterations));
+    escapeRadiusInput->setText(QString::number(escapeRadius));
+    realCenterInput->setText(QString::number(realCenter));
+    imagCenterInput->setText(QString::number(imagCenter));
+    rangeInput->setText(QString::number(range));
+    renderModeComboBox->setCurrentIndex(renderMode);
+    atlasGridInput->setText(QString::number(atlasLayout.columns));
+    atlasCoeffInput->setText(QString::number(atlasLayout.coeffIndex));
+
+    // 输入框中的数值经过了格式化，以输入框为准，避免因精度差异触发重新计算
+    realCenter = realCenterInput->text().toDouble();
+    imagCenter = imagCenterInput->text().toDouble();
+    range = rangeInput->text().toDouble();
+    escapeRadius = escapeRadiusInput->text().toDouble();
+
+    try {
+        juliaFunc = getRationalFunctionLambda(func_str).first;
+    } catch (...) {
+        juliaFunc = nullptr;
+    }
+    JuliaMatrix = file.readAll();
+    escapeState = EscapeTimeState();
+    // 迭代数据中没有平滑值，按整数迭代次数上色；内核和对称性不影响迭代次数，以界面为准
+    useSmooth = smoothCheckBox->isChecked();
+    smoothMatrix.clear();
+    kernel = kernelComboBox->currentIndex();
+    useSymmetry = symmetryCheckBox->isChecked();
+    // 吸引域模式的文件中保存了每个像素所属的吸引子，旧文件中没有时按收敛步数和颜色映射上色
+    basinCount = params.basinCount;
+    if(basinCount > 0)
+        basinMatrix = file.readAll(IterationFile::BasinPlane);
+    else
+        basinMatrix.clear();
+    // 参数已全部同步，onGenerateButtonClicked 只重新上色，不会丢弃读入的数据重新计算
+    Q_ASSERT_X(!needsRecompute(resolutionInput->text().toInt(), maxIterInput->text().toInt()),
+               "loadIterationFile", "加载迭代数据后参数未同步");
+    onGenerateButtonClicked(false);
+    displayLabel->setText("已加载迭代数据： " + path);
+}
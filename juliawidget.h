@@ -7,6 +7,17 @@
 #include <QScrollArea>
 #include <QPushButton>
 #include <QComboBox>
+#include <QCheckBox>
+#include <QListWidget>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <functional>
+#include <complex>
+#include <memory>
+#include "juliadraw.h"
+#include "iterationfile.h"
+#include "exportqueue.h"
+#include "juliaexplorer.h"
 //#include <complex>
 
 class JuliaWidget : public QWidget {
@@ -14,36 +25,42 @@ class JuliaWidget : public QWidget {
 
 public:
     explicit JuliaWidget(QWidget* parent = nullptr);
+    // 取消并等待后台的轨道密度计算
+    ~JuliaWidget() override;
 
 public slots:
-    // 通过快捷键移动
+    // 通过快捷键移动，按交互帧生成（见 interactiveGenerate）
     void moveRight(){
         //resolutionInput->setText(QString::number(scrollArea->size().height() < scrollArea->size().width() ? scrollArea->size().height() : scrollArea->size().width()));
         realCenterInput->setText(QString::number(realCenterInput->text().toDouble() + rangeInput->text().toDouble()/5));
-        onGenerateButtonClicked(false);
+        interactiveGenerate();
     }
     void moveLeft(){
         realCenterInput->setText(QString::number(realCenterInput->text().toDouble() - rangeInput->text().toDouble()/5));
-        onGenerateButtonClicked(false);
+        interactiveGenerate();
     }
     void moveDown(){
         imagCenterInput->setText(QString::number(imagCenterInput->text().toDouble() + rangeInput->text().toDouble()/5));
-        onGenerateButtonClicked(false);
+        interactiveGenerate();
     }
     void moveUp(){
         imagCenterInput->setText(QString::number(imagCenterInput->text().toDouble() - rangeInput->text().toDouble()/5));
-        onGenerateButtonClicked(false);
+        interactiveGenerate();
     }
     void scaleUp(){
         rangeInput->setText(QString::number(rangeInput->text().toDouble()*0.8));
-        onGenerateButtonClicked(false);
+        interactiveGenerate();
     }
     void scaleDown(){
         rangeInput->setText(QString::number(rangeInput->text().toDouble()*1.2));
-        onGenerateButtonClicked(false);
+        interactiveGenerate();
     }
 
     void onGenerateButtonClicked(bool saveImage=true);
+    // 加载 .jit 迭代数据，恢复参数并直接重新上色
+    void loadIterationFile(const QString& path);
+    // 把当前画面按导出分辨率加入后台导出队列
+    void exportCurrentView();
     //void onColorMapChanged(int index); // 下拉框的变化
 
 private:
@@ -61,6 +78,8 @@ private:
     std::string func_str = "z^2+(-0.7+0.27015i)";
 
     std::vector<std::vector<int>> JuliaMatrix;
+    // 生成当前 JuliaMatrix 所用的函数，抗锯齿追加采样时需要
+    std::function<std::complex<double>(std::complex<double>)> juliaFunc;
 
 
     // 图像颜色映射使用的HSV
@@ -87,14 +106,108 @@ private:
 
     QComboBox *colorMapComboBox;
 
+    // 渲染模式，见 RenderMode
+    QComboBox* renderModeComboBox;
+    int renderMode = -1;
+    // 利用函数对称性只计算基本区域
+    QCheckBox* symmetryCheckBox;
+    bool useSymmetry = false;
+    QString symmetryInfo; // 上一次计算中对称性或区间认证的说明
+    // 迭代内核，见 IterationKernel
+    QComboBox* kernelComboBox;
+    int kernel = -1;
+    // 平滑着色：逃逸时间模式下额外保存每个像素的平滑（分数）逃逸值，按它上色
+    QCheckBox* smoothCheckBox;
+    bool useSmooth = false;
+    std::vector<std::vector<float>> smoothMatrix;
+    // 续算：保存上一次逃逸时间结果中每个像素停止时的 z
+    QCheckBox* resumeCheckBox;
+    EscapeTimeState escapeState;
+    QString resumeInfo; // 上一次续算的说明
+    // 吸引域模式：JuliaMatrix 为收敛步数，basinMatrix 为每个像素所属的吸引子（-1 为未收敛）
+    std::vector<std::vector<int>> basinMatrix;
+    int basinCount = 0; // 吸引子个数，包括无穷远点
+    int orbitSamplesPerPixel = 20; // 轨道密度模式下每个像素平均的起点采样数
+
+    // 参数图集：画面中心和范围描述的是参数平面，每格缩略图绘制 [-1.5, 1.5]^2
+    QLineEdit* atlasGridInput;  // 每行/列的格数
+    QLineEdit* atlasCoeffInput; // 变化的是分子中 z^k 的系数
+    AtlasLayout atlasLayout;
+    double atlasViewRange = 3.0;
+
+    // 自适应抗锯齿：只对迭代次数与邻域相差超过阈值的像素追加抖动采样
+    QCheckBox* adaptiveAACheckBox;
+    int aaThreshold = 1;    // 邻域迭代次数差阈值
+    int aaExtraSamples = 8; // 边缘像素追加的采样数
+
+    // 渲染线程数（0 为自动）与核心绑定
+    QLineEdit* threadCountInput;
+    QCheckBox* pinThreadsCheckBox;
+
+    // 保存设置，保存在后台线程中进行
+    QComboBox* saveFormatComboBox;
+    QLineEdit* pngCompressionInput;
+    int pendingSaves = 0; // 尚未完成的后台保存任务数
+
+    // 后台导出队列及其任务列表
+    QLineEdit* exportResolutionInput;
+    QLineEdit* exportCheckpointInput; // 检查点间隔（秒），0 为不使用
+    QListWidget* exportList;
+    ExportQueue* exportQueue;
+
+    // 交互帧的质量控制：快捷键移动/缩放时按帧时间预算临时降低分辨率和最大迭代次数，
+    // 停止操作 refineTimer 的间隔后再按输入框中的设置生成
+    QCheckBox* frameBudgetCheckBox;
+    QLineEdit* frameBudgetInput; // 帧时间预算（毫秒）
+    FrameQualityController frameQuality;
+    QTimer* refineTimer;
+    int frameResolution = -1;    // 大于 0 时覆盖 resolutionInput，只在 interactiveGenerate 中设置
+    int frameMaxIterations = -1; // 大于 0 时覆盖 maxIterInput
+    double framePredictedSeconds = 0;
+    QString frameInfo; // 上一次计算的分辨率、耗时和吞吐量
+
+    // 轨道密度在后台线程中计算，可以取消；完成后再调用 onGenerateButtonClicked 上色
+    struct DensityResult {
+        std::vector<std::vector<int>> matrix;
+        int generation = 0;
+        bool completed = false;
+    };
+    QPushButton* cancelRenderButton;
+    QFutureWatcher<DensityResult> densityWatcher;
+    std::shared_ptr<RenderControl> densityControl;
+    int densityGeneration = 0;         // 每次开始或放弃计算时加一，过时的结果直接丢弃
+    bool densitySaveRequested = false; // 计算期间请求了保存，完成后保存
+    void startDensityRender(bool saveImage);
+    // 放弃正在进行的计算（被新的计算取代），不报告取消
+    void abandonDensityRender();
+    void onDensityFinished();
+
+    // Mandelbrot/Julia 联动浏览
+    QCheckBox* explorerCheckBox;
+    JuliaExplorer* explorer;
+
     QLabel* displayLabel;
     QLabel* imageLabel;
     QImage originalImage; // 保存原始高分辨率图像
     QPixmap originalPixmap;
 
     QPushButton* generateButton;  //生成图像的按钮
+    QPushButton* loadButton;      //加载迭代数据的按钮
 
     void setupUI();
+    // 交互帧：开启帧时间预算时按控制器选择的质量生成，并在停止操作后按完整设置重新生成
+    void interactiveGenerate();
+    // 界面中的设置与上一次计算的参数不同，需要重新计算矩阵
+    bool needsRecompute(int requestedResolution, int requestedMaxIterations) const;
+    // 当前 JuliaMatrix 对应的迭代数据文件参数
+    IterationFileParams currentIterationFileParams() const;
+    // 保存文件名中除后缀外的部分，pixels 为图像边长，iterations 为最大迭代次数
+    std::string outputBaseName(int pixels, int iterations) const;
+
+private slots:
+    void onExportJobChanged(int id);
+    // 联动浏览中选定 c：函数改为 z^2+c，按帧时间预算生成图像，停下后再按完整设置生成
+    void onExplorerParameterChosen(double real, double imag);
 
 protected:
     void resizeEvent(QResizeEvent* event) override;
@@ -103,6 +216,8 @@ protected:
     void mousePressEvent(QMouseEvent* event) override;
     void mouseMoveEvent(QMouseEvent* event) override;
     void mouseReleaseEvent(QMouseEvent* event) override;
+    // 参数图集模式下双击某一格，使用该格的参数
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
 };
 
 #endif // JULIAWIDGET_H
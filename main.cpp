@@ -1,11 +1,16 @@
 #include <QApplication>
 #include "juliawidget.h"
 #include "colormap.h"
+#include "commandline.h"
 #include <QFile>
 #include <QShortcut>
 #include <QMessageBox>
 
 int main(int argc, char* argv[]) {
+    // 带有命令行动作时不启动图形界面
+    if(isCommandLineInvocation(argc, argv))
+        return runCommandLine(argc, argv);
+
     QApplication app(argc, argv);
     if(!QFile::exists("colormaps.png"))
         ColorMap::generateColorMapImage();
@@ -33,6 +38,7 @@ int main(int argc, char* argv[]) {
 
     bindKeys([&](){ widget.onGenerateButtonClicked(true); },  "Ctrl+S");
     bindKeys([&](){ widget.onGenerateButtonClicked(false); }, "Ctrl+D");
+    bindKeys(&JuliaWidget::exportCurrentView, "Ctrl+E");
     widget.show();
     return app.exec();
 }